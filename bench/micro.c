@@ -0,0 +1,444 @@
+/**
+ * micro.c - Hot-path microbenchmarks (make bench)
+ *
+ * Runs the game's own functions on a headless GameState (virtual clock,
+ * SIM_TICK), and render_game on ncurses writing to /dev/null. Prints one
+ * JSON document on stdout; for every benchmark:
+ *
+ *     ops            operations timed
+ *     ns_per_op      wall time
+ *     cycles_per_op  CPU cycles from perf_event_open, or TSC ticks where
+ *                    that is not permitted ("cycles_source"), else null
+ *     allocs_per_op  malloc/calloc/realloc calls made by the game code
+ *                    (wrapped at link time, see the Makefile)
+ *     locks_per_op   mutex acquisitions, from the profiler's LOCK
+ *                    counters in a second pass with the profiler on, so
+ *                    the timed pass runs without it
+ *
+ * Before timing anything, every collide_box64 variant the CPU supports is
+ * checked against the scalar kernel on random boxes ("collide_check");
+ * a mismatch fails the run, so a dispatch regression stops `make bench`.
+ *
+ * Each benchmark is a batch function: untimed setup, then its core
+ * bracketed by marca()/acumular(), whose own cost is measured at start and
+ * subtracted from both ns and cycles ("timer_overhead_ns"). A bracket
+ * times many operations, or one that runs for microseconds, so that
+ * correction stays small next to what it is taken from. Numbers are as good as the build: use
+ * e.g. make clean && make bench CFLAGS='-O2 -std=c11 -pthread' to time
+ * optimized code.
+ */
+#define _GNU_SOURCE
+
+#include "game.h"
+#include "threads.h"
+#include "render.h"
+#include "snapshot.h"
+#include "particles.h"
+#include "prof.h"
+#include "collide.h"
+#include <fcntl.h>
+#include <linux/perf_event.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#define LARGURA      200     /* screen (and world) size */
+#define ALTURA       60
+#define CAP          4096    /* ship and rocket pools */
+#define LANCADORES   64
+#define TEMPO_MIN_NS 200000000ULL   /* timed pass: at least 0.2 s per benchmark */
+#define LOTES_LOCKS  3              /* batches in the counting pass */
+
+/* ===== Allocation counter (-Wl,--wrap=malloc,...) ===== */
+
+static _Atomic long s_allocs;
+
+void* __real_malloc(size_t n);
+void* __real_calloc(size_t k, size_t n);
+void* __real_realloc(void* p, size_t n);
+
+void* __wrap_malloc(size_t n) {
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+    return __real_malloc(n);
+}
+void* __wrap_calloc(size_t k, size_t n) {
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+    return __real_calloc(k, n);
+}
+void* __wrap_realloc(void* p, size_t n) {
+    atomic_fetch_add_explicit(&s_allocs, 1, memory_order_relaxed);
+    return __real_realloc(p, n);
+}
+
+/* ===== Cycle counter ===== */
+
+static int s_perf_fd = -1;
+static const char* s_ciclos_fonte = "none";
+
+static void ciclos_init(void) {
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof a);
+    a.type = PERF_TYPE_HARDWARE;
+    a.size = sizeof a;
+    a.config = PERF_COUNT_HW_CPU_CYCLES;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    s_perf_fd = (int)syscall(SYS_perf_event_open, &a, 0, -1, -1, 0);
+    if (s_perf_fd >= 0) s_ciclos_fonte = "perf";
+#if defined(__x86_64__) || defined(__i386__)
+    else s_ciclos_fonte = "tsc";
+#endif
+}
+
+static uint64_t ciclos(void) {
+    uint64_t v = 0;
+    if (s_perf_fd >= 0) {
+        if (read(s_perf_fd, &v, sizeof v) != (ssize_t)sizeof v) v = 0;
+        return v;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+/* ===== Measurement ===== */
+
+typedef struct { uint64_t ns, ciclos, locks; long ops, allocs, marcas; } Medida;
+typedef struct { uint64_t ns, ciclos, locks; long allocs; } Marca;
+
+static uint64_t locks_total(void) {
+    uint64_t n = 0;
+    for (int i = 0; i < PROF_NUM_MTX; i++) n += atomic_load_explicit(&prof_mutex[i].count, memory_order_relaxed);
+    return n;
+}
+
+static Marca marca(void) {
+    Marca m;
+    m.allocs = atomic_load_explicit(&s_allocs, memory_order_relaxed);
+    m.locks = locks_total();
+    m.ciclos = ciclos();
+    m.ns = prof_now_ns();
+    return m;
+}
+
+static void acumular(Medida* m, Marca ini, long ops) {
+    const uint64_t ns = prof_now_ns(), c = ciclos();
+    m->ns += ns - ini.ns;
+    m->ciclos += c - ini.ciclos;
+    m->locks += locks_total() - ini.locks;
+    m->allocs += atomic_load_explicit(&s_allocs, memory_order_relaxed) - ini.allocs;
+    m->ops += ops;
+    m->marcas++;
+}
+
+/* Cost of an empty marca()/acumular() bracket, taken off every result */
+static double s_vazio_ns, s_vazio_ciclos;
+
+static void calibrar(void) {
+    Medida m = { 0 };
+    for (int i = 0; i < 100000; i++) acumular(&m, marca(), 0);
+    s_vazio_ns = (double)m.ns / (double)m.marcas;
+    s_vazio_ciclos = (double)m.ciclos / (double)m.marcas;
+}
+
+/* ===== World ===== */
+
+static GameState s_game;
+static DifficultyConfig s_perfil;
+static volatile int s_sink;
+
+/* The bench profile spawns one ship per ms: the next `naves` entries of
+   the timeline fall due and enter in one game_spawn_tick */
+static int admitir(int naves) {
+    GameState* g = &s_game;
+    const int antes = atomic_load(&g->naves_spawned);
+    int64_t prox = 0;
+    g->relogio_ms += naves;
+    game_spawn_tick(g, game_now_ms(g), &prox);
+    return atomic_load(&g->naves_spawned) - antes;
+}
+
+/* Fresh round with every launcher loaded and `naves` ships on the field */
+static void preparar(int naves) {
+    GameState* g = &s_game;
+    game_reset(g);
+    g->relogio_ms += g->tempo_recarga;
+    recarga_tick(g, game_now_ms(g));
+    admitir(naves);
+}
+
+/* Ships spread over the upper field instead of all on the spawn row */
+static void espalhar_naves(void) {
+    GameState* g = &s_game;
+    EntityCols* c = &g->col_naves;
+    LOCK(g, naves);
+    for (int p = 0; p < c->num; p++) {
+        int x = (int)(game_rand(g) % LARGURA), y = 3 + (int)(game_rand(g) % (ALTURA / 2));
+        c->x[p] = x; c->y[p] = y;
+        c->ox[p] = FX_CENTRO(x); c->oy[p] = FX_CENTRO(y);
+        c->t0_ms[p] = game_now_ms(g);
+        grid_move(&g->grid_naves, c->id[p], x, y);
+    }
+    UNLOCK(g, naves);
+}
+
+/* ===== Benchmarks ===== */
+
+/* A swarm's worth of due entries admitted at once, timeline refills included */
+static void b_spawn_lote(Medida* m) {
+    preparar(0);
+    Marca t = marca();
+    const int n = admitir(CAP);
+    acumular(m, t, n);
+}
+
+static void b_tentar_disparar(Medida* m) {
+    preparar(0);
+    long n = 0;
+    Marca t = marca();
+    while (tentar_disparar(&s_game)) n++;
+    acumular(m, t, n);
+}
+
+static void colisao(Medida* m, int naves) {
+    static int qx[1024], qy[1024];
+    preparar(naves);
+    espalhar_naves();
+    for (int i = 0; i < 1024; i++) {
+        qx[i] = (int)(game_rand(&s_game) % LARGURA);
+        qy[i] = 3 + (int)(game_rand(&s_game) % (ALTURA / 2));
+    }
+    GameState* g = &s_game;
+    int acc = 0;
+    Marca t = marca();
+    for (int r = 0; r < 16; r++) {
+        LOCK(g, naves);
+        for (int i = 0; i < 1024; i++) acc += nave_colidindo(g, qx[i], qy[i]);
+        UNLOCK(g, naves);
+    }
+    acumular(m, t, 16 * 1024);
+    s_sink = acc;
+}
+static void b_colisao_scan(Medida* m) { colisao(m, 256); }    /* <= COLLIDE_SCAN_MAX: SIMD scan */
+static void b_colisao_grid(Medida* m) { colisao(m, 2048); }   /* grid broad-phase */
+
+/* Steady play: 2000 ships, every launcher firing as it reloads, sweeping */
+static void b_sim_tick(Medida* m) {
+    GameState* g = &s_game;
+    preparar(2000);
+    espalhar_naves();
+    long passos = 0;
+    Marca t = marca();
+    for (int k = 0; k < 400; k++) {
+        const int64_t now = game_now_ms(g);
+        recarga_tick(g, now);
+        g->bateria_x = (k * 7) % LARGURA;
+        g->direcao_atual = (DirecaoDisparo)(k % 3);
+        while (tentar_disparar(g)) {}
+        passos += sim_tick(g, now);
+        game_drenar_eventos(g, NULL);
+        g->relogio_ms += g->tick_ms;
+    }
+    acumular(m, t, passos > 0 ? passos : 1);
+}
+
+static void b_snapshot_publish(Medida* m) {
+    preparar(2000);
+    while (tentar_disparar(&s_game)) {}
+    Marca t = marca();
+    for (int i = 0; i < 100; i++) snapshot_publish(s_game.snap_render, &s_game);
+    acumular(m, t, 100);
+}
+
+/* A fresh frame on each of ACQUIRE_LOTE channels, then one bracket around
+   taking them all: one acquire is a few ns, far below the bracket's own
+   cost, and the channel only holds one unseen frame at a time */
+#define ACQUIRE_LOTE 256
+
+static void b_snapshot_acquire(Medida* m) {
+    static SnapChannel sc[ACQUIRE_LOTE];
+    static bool pronto = false;
+    if (!pronto) {
+        for (int i = 0; i < ACQUIRE_LOTE; i++) snapshot_init(&sc[i], 1, 1);
+        pronto = true;
+    }
+    for (int i = 0; i < ACQUIRE_LOTE; i++) {
+        snapshot_begin(&sc[i])->num_naves = i;
+        snapshot_commit(&sc[i]);
+    }
+    int acc = 0;
+    Marca t = marca();
+    for (int i = 0; i < ACQUIRE_LOTE; i++) acc += snapshot_acquire(&sc[i])->num_naves;
+    acumular(m, t, ACQUIRE_LOTE);
+    s_sink = acc;
+}
+
+static void b_render_game(Medida* m) {
+    preparar(500);
+    espalhar_naves();
+    while (tentar_disparar(&s_game)) {}
+    for (int i = 0; i < 50; i++) {
+        snapshot_publish(s_game.snap_render, &s_game);
+        if (i % 10 == 0) render_add_explosion(i * 3, 10);
+        Marca t = marca();
+        render_game(&s_game);
+        acumular(m, t, 1);
+    }
+}
+
+/* One rendered frame of effects with 50 new explosions (burst + 6 debris)
+   a frame, a few thousand particles live */
+static void b_part_avancar(Medida* m) {
+    static Particulas p;
+    static bool pronto = false;
+    if (!pronto) { part_init(&p, 8192); pronto = true; }
+    Marca t = marca();
+    for (int f = 0; f < 200; f++) {
+        for (int k = 0; k < 50; k++) {
+            const int x = (f * 13 + k * 7) % LARGURA, y = 5 + k % 40;
+            part_emitir(&p, PART_EXPLOSAO, x, y, 0, 0, 5, '*');
+            for (int d = 0; d < 6; d++)
+                part_emitir(&p, PART_DETRITO, x, y, (d - 3) * 64, -128 + d * 16, 6 + d % 5, '.');
+        }
+        part_avancar(&p);
+    }
+    acumular(m, t, 200);
+    s_sink = p.vivas;
+}
+
+/* ===== SIMD equivalence ===== */
+
+#define CHECK_CASOS 200000
+
+/* Random point, radius and up to 64 positions clustered around it, so
+   hits, misses and |d| == r edges all occur; lanes past n hold garbage
+   the kernels must ignore. Returns mismatching cases (stderr lists up to 5). */
+static long verificar_colisao(FILE* out) {
+    collide_box_fn fns[8];
+    const char* nomes[8];
+    const int nv = collide_variantes(fns, nomes, 8);
+    int xs[COLLIDE_BATCH], ys[COLLIDE_BATCH];
+    uint32_t s = 0x9E3779B9u;
+#define SORTE() (s ^= s << 13, s ^= s >> 17, s ^= s << 5, s)
+    long erros = 0;
+    for (long k = 0; k < CHECK_CASOS; k++) {
+        const int x = (int)(SORTE() % 2001) - 1000, y = (int)(SORTE() % 2001) - 1000;
+        const int r = (int)(SORTE() % 6), n = (int)(SORTE() % (COLLIDE_BATCH + 1));
+        for (int i = 0; i < COLLIDE_BATCH; i++) {
+            xs[i] = x + (int)(SORTE() % 15) - 7;
+            ys[i] = y + (int)(SORTE() % 15) - 7;
+        }
+        const uint64_t ref = fns[0](xs, ys, n, x, y, r);
+        for (int v = 1; v < nv; v++) {
+            const uint64_t m = fns[v](xs, ys, n, x, y, r);
+            if (m != ref && erros++ < 5)
+                fprintf(stderr, "collide: %s != scalar (n %d r %d): %016llx vs %016llx\n", nomes[v], n, r,
+                        (unsigned long long)m, (unsigned long long)ref);
+        }
+    }
+#undef SORTE
+    fprintf(out, "  \"collide_check\": {\"variants\": [");
+    for (int v = 0; v < nv; v++) fprintf(out, "%s\"%s\"", v ? ", " : "", nomes[v]);
+    fprintf(out, "], \"dispatch\": \"%s\", \"cases\": %d, \"mismatches\": %ld},\n",
+            collide_impl_name(), CHECK_CASOS, erros);
+    return erros;
+}
+
+/* ===== Harness ===== */
+
+typedef struct { const char* nome; void (*lote)(Medida*); } Bench;
+
+static const Bench BENCHES[] = {
+    { "spawn_lote_4096",    b_spawn_lote },
+    { "tentar_disparar",    b_tentar_disparar },
+    { "colisao_scan_256",   b_colisao_scan },
+    { "colisao_grid_2048",  b_colisao_grid },
+    { "sim_tick_step",      b_sim_tick },
+    { "snapshot_publish",   b_snapshot_publish },
+    { "snapshot_acquire",   b_snapshot_acquire },
+    { "render_game",        b_render_game },
+    { "part_avancar_frame", b_part_avancar },
+};
+#define NUM_BENCHES (int)(sizeof(BENCHES) / sizeof(BENCHES[0]))
+
+static void correr(FILE* out, const Bench* b, bool ultimo) {
+    Medida aquece = { 0 }, t = { 0 }, l = { 0 };
+    prof_set(false);
+    b->lote(&aquece);
+    while (t.ns < TEMPO_MIN_NS) b->lote(&t);
+    prof_set(true);
+    for (int i = 0; i < LOTES_LOCKS; i++) b->lote(&l);
+    prof_set(false);
+
+    const double ops = (double)t.ops, marcas = (double)t.marcas;
+    double ns = ((double)t.ns - marcas * s_vazio_ns) / ops, cic = ((double)t.ciclos - marcas * s_vazio_ciclos) / ops;
+    fprintf(out, "    {\"name\": \"%s\", \"ops\": %ld, \"ns_per_op\": %.2f, \"cycles_per_op\": ", b->nome, t.ops,
+            ns > 0 ? ns : 0.0);
+    if (strcmp(s_ciclos_fonte, "none") == 0) fprintf(out, "null");
+    else fprintf(out, "%.1f", cic > 0 ? cic : 0.0);
+    fprintf(out, ", \"allocs_per_op\": %.4f, \"locks_per_op\": %.3f}%s\n", (double)t.allocs / ops,
+            l.ops ? (double)l.locks / (double)l.ops : 0.0, ultimo ? "" : ",");
+    fflush(out);
+}
+
+int main(int argc, char** argv) {
+    const char* filtro = (argc > 1) ? argv[1] : NULL;   /* substring of the names to run */
+
+    /* JSON keeps the real stdout; ncurses and term.c get /dev/null */
+    FILE* out = fdopen(dup(STDOUT_FILENO), "w");
+    int nulo = open("/dev/null", O_RDWR);
+    if (!out || nulo < 0) { perror("bench"); return 1; }
+    dup2(nulo, STDOUT_FILENO);
+    dup2(nulo, STDIN_FILENO);
+    close(nulo);
+    setenv("TERM", "xterm", 0);
+    char dim[16];
+    snprintf(dim, sizeof dim, "%d", LARGURA); setenv("COLUMNS", dim, 1);
+    snprintf(dim, sizeof dim, "%d", ALTURA);  setenv("LINES", dim, 1);
+
+    s_perfil = DIFFS[2];
+    s_perfil.launchers = LANCADORES;
+    s_perfil.spawn_min_ms = s_perfil.spawn_max_ms = 1;
+    s_perfil.formacao_max = 1;
+    s_perfil.enxame = 0;
+    GameOptions opts = {
+        .dificuldade = 2, .perfil = &s_perfil, .sim_mode = SIM_TICK, .tick_ms = DEF_TICK_MS,
+        .headless = true, .seed = 42, .ships = 1 << 30, .max_naves = CAP, .max_foguetes = CAP,
+    };
+    if (game_init(&s_game, &opts) != 0) { fprintf(stderr, "bench: game_init failed\n"); return 1; }
+    game_resize(&s_game, LARGURA, ALTURA);
+    render_set_mode(RENDER_DIFF);
+    render_init();
+    ciclos_init();
+    calibrar();
+
+    fprintf(out, "{\n  \"bench\": \"micro\",\n  \"cycles_source\": \"%s\",\n  \"timer_overhead_ns\": %.1f,\n",
+            s_ciclos_fonte, s_vazio_ns);
+    if (verificar_colisao(out) != 0) {
+        fprintf(out, "  \"results\": []\n}\n");
+        fclose(out);
+        fprintf(stderr, "bench: SIMD collision kernels disagree with scalar\n");
+        return 1;
+    }
+    fprintf(out, "  \"results\": [\n");
+    int ultimo = -1;
+    for (int i = 0; i < NUM_BENCHES; i++)
+        if (!filtro || strstr(BENCHES[i].nome, filtro)) ultimo = i;
+    for (int i = 0; i <= ultimo; i++)
+        if (!filtro || strstr(BENCHES[i].nome, filtro)) correr(out, &BENCHES[i], i == ultimo);
+    fprintf(out, "  ]\n}\n");
+
+    render_cleanup();
+    game_cleanup(&s_game);
+    if (s_perf_fd >= 0) close(s_perf_fd);
+    fclose(out);
+    return 0;
+}
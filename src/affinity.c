@@ -0,0 +1,131 @@
+/**
+ * affinity.c - Thread pinning and SCHED_FIFO / nice fallback (see affinity.h)
+ */
+#define _GNU_SOURCE
+
+#include "affinity.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const char* const PAPEL_NOMES[AFIN_NUM] = { "render", "input" };
+
+/* What a thread asked for and what it got; written by that thread only,
+   read by afin_relatorio after it has been joined */
+typedef struct {
+    bool aplicado;
+    int cpu;                 /* pinned core, -1 = inherited mask */
+    int politica, prio;      /* effective, from pthread_getschedparam */
+    int nice;
+    char nota[96];           /* refusals */
+} AfinEstado;
+
+static AfinOpcoes s_opcoes = { .cpu = { -1, -1 } };
+static bool s_preparado = false;
+static int s_partilhados = 0;   /* cores left to the other threads, 0 = not restricted */
+static AfinEstado s_estado[AFIN_NUM];
+
+int afin_preparar(const AfinOpcoes* o) {
+    s_opcoes = *o;
+    s_preparado = afin_pedido(o);
+    if (!s_preparado) return 0;
+
+    cpu_set_t todos, resto;
+    if (sched_getaffinity(0, sizeof todos, &todos) != 0) {
+        fprintf(stderr, "Cannot read the CPU mask: %s\n", strerror(errno));
+        return -1;
+    }
+    resto = todos;
+    for (int p = 0; p < AFIN_NUM; p++) {
+        const int c = o->cpu[p];
+        if (c < 0) continue;
+        if (c >= CPU_SETSIZE || !CPU_ISSET(c, &todos)) {
+            fprintf(stderr, "CPU %d is not available for --pin-%s.\n", c, PAPEL_NOMES[p]);
+            return -1;
+        }
+        CPU_CLR(c, &resto);
+    }
+
+    /* Threads inherit their creator's mask: everything started after this
+       (pool, tick loop, reloader, server, input) stays off the pinned cores */
+    if (CPU_COUNT(&resto) > 0 && CPU_COUNT(&resto) < CPU_COUNT(&todos) &&
+        sched_setaffinity(0, sizeof resto, &resto) == 0)
+        s_partilhados = CPU_COUNT(&resto);
+    return 0;
+}
+
+int afin_nucleos_partilhados(void) { return s_partilhados; }
+
+/* Lowest nice value this thread may take: AFIN_NICE, or RLIMIT_NICE's floor
+   (20 - rlim_cur) when that is higher */
+static int nice_permitido(void) {
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NICE, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY) return AFIN_NICE;
+    int piso = 20 - (int)rl.rlim_cur;
+    return (piso > AFIN_NICE) ? piso : AFIN_NICE;
+}
+
+void afin_aplicar(AfinPapel papel) {
+    if (!s_preparado) return;
+    AfinEstado* e = &s_estado[papel];
+    memset(e, 0, sizeof *e);
+    e->aplicado = true;
+    e->cpu = -1;
+    const pid_t tid = (pid_t)syscall(SYS_gettid);
+    size_t n = 0;
+
+    const int c = s_opcoes.cpu[papel];
+    if (c >= 0) {
+        cpu_set_t um;
+        CPU_ZERO(&um);
+        CPU_SET(c, &um);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof um, &um);
+        if (rc == 0) e->cpu = c;
+        else n += (size_t)snprintf(e->nota + n, sizeof e->nota - n, " pin refused: %s;", strerror(rc));
+    }
+
+    if (s_opcoes.rt_prio > 0) {
+        struct sched_param sp = { .sched_priority = s_opcoes.rt_prio };
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp);
+        if (rc != 0) {
+            n += (size_t)snprintf(e->nota + n, sizeof e->nota - n, " SCHED_FIFO refused: %s;", strerror(rc));
+            const int alvo = nice_permitido();
+            errno = 0;
+            const int atual = getpriority(PRIO_PROCESS, (id_t)tid);
+            if (errno == 0 && alvo >= atual)
+                n += (size_t)snprintf(e->nota + n, sizeof e->nota - n, " RLIMIT_NICE allows no lower nice;");
+            else if (errno == 0 && setpriority(PRIO_PROCESS, (id_t)tid, alvo) != 0)
+                n += (size_t)snprintf(e->nota + n, sizeof e->nota - n, " nice %d refused: %s;",
+                                      alvo, strerror(errno));
+        }
+    }
+    if (n > 0 && n < sizeof e->nota) e->nota[n - 1] = '\0';   /* drop the last ';' */
+
+    struct sched_param sp;
+    if (pthread_getschedparam(pthread_self(), &e->politica, &sp) == 0) e->prio = sp.sched_priority;
+    errno = 0;
+    e->nice = getpriority(PRIO_PROCESS, (id_t)tid);
+    if (errno != 0) e->nice = 0;
+}
+
+void afin_relatorio(FILE* f) {
+    if (!s_preparado) return;
+    fprintf(f, "Scheduling:");
+    const char* sep = " ";
+    for (int p = 0; p < AFIN_NUM; p++) {
+        const AfinEstado* e = &s_estado[p];
+        if (!e->aplicado) continue;
+        fprintf(f, "%s%s", sep, PAPEL_NOMES[p]);
+        if (e->cpu >= 0) fprintf(f, " cpu %d", e->cpu);
+        if (e->politica == SCHED_FIFO) fprintf(f, " SCHED_FIFO %d", e->prio);
+        else fprintf(f, " nice %d", e->nice);
+        if (e->nota[0]) fprintf(f, " (%s)", e->nota + 1);
+        sep = " | ";
+    }
+    if (s_partilhados) fprintf(f, "%sothers on %d cores", sep, s_partilhados);
+    fprintf(f, "\n");
+}
@@ -0,0 +1,52 @@
+#ifndef AFFINITY_H
+#define AFFINITY_H
+
+/**
+ * affinity.h - CPU pinning and real-time priority for the latency-critical
+ * threads (--pin-render, --pin-input, --rt)
+ *
+ * The renderer (the main thread) and the input thread can each be pinned
+ * to a core. Every other thread — pool workers, the tick loop, the
+ * reloader, the spectator server — is created under a process mask with
+ * those cores taken out, so the pinned cores really are dedicated (unless
+ * that would leave nothing, in which case they are shared).
+ *
+ * --rt PRIO asks for SCHED_FIFO at PRIO for both threads. Where that is
+ * refused (no CAP_SYS_NICE, RLIMIT_RTPRIO too low) each falls back to
+ * nice AFIN_NICE, or the lowest value RLIMIT_NICE allows, and where that
+ * is refused as well it keeps the default policy. Every outcome is kept
+ * and printed at exit by afin_relatorio. Linux only.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+
+#define AFIN_NICE -10    /* fallback when SCHED_FIFO is not permitted */
+
+typedef enum { AFIN_RENDER, AFIN_INPUT, AFIN_NUM } AfinPapel;
+
+typedef struct {
+    int cpu[AFIN_NUM];   /* -1 = not pinned */
+    int rt_prio;         /* SCHED_FIFO priority, 0 = none requested */
+} AfinOpcoes;
+
+static inline bool afin_pedido(const AfinOpcoes* o) {
+    return o->cpu[AFIN_RENDER] >= 0 || o->cpu[AFIN_INPUT] >= 0 || o->rt_prio > 0;
+}
+
+/* Main thread, before any other thread exists: checks the cores and takes
+   the pinned ones out of the process mask. 0 on success, -1 (after a
+   message on stderr) if a core is not available to this process. */
+int afin_preparar(const AfinOpcoes* o);
+
+/* Cores left to every other thread, 0 if the mask was not restricted */
+int afin_nucleos_partilhados(void);
+
+/* The calling thread takes the settings of `papel` and records what it
+   actually got; no-op before afin_preparar or when nothing was asked */
+void afin_aplicar(AfinPapel papel);
+
+/* Effective settings of every configured thread, on one line */
+void afin_relatorio(FILE* f);
+
+#endif /* AFFINITY_H */
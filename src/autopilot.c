@@ -0,0 +1,142 @@
+/**
+ * autopilot.c - Intercept solver and gunner (see autopilot.h)
+ */
+#include "autopilot.h"
+#include "input.h"
+#include "prof.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const int TECLA_DIR[] = {
+    [DIR_VERTICAL] = 'w',       [DIR_DIAGONAL_ESQ] = 'q',   [DIR_DIAGONAL_DIR] = 'e',
+    [DIR_HORIZONTAL_ESQ] = 'z', [DIR_HORIZONTAL_DIR] = 'c',
+};
+
+int autopilot_init(Autopilot* a, const GameState* game) {
+    memset(a, 0, sizeof(*a));
+    if (snapshot_init(&a->canal, game->cap_naves, game->cap_foguetes) != 0) return -1;
+    a->prox_ms = game_now_ms(game);
+    return 0;
+}
+
+void autopilot_free(Autopilot* a) {
+    snapshot_free(&a->canal);
+    free(a->faixas);
+    a->faixas = NULL;
+    a->largura = 0;
+}
+
+void autopilot_reset(Autopilot* a, const GameState* game) {
+    a->prox_ms = game_now_ms(game);
+}
+
+static inline int sinal(int32_t v) { return (v > 0) - (v < 0); }
+
+/* Lane of (x, y) for direction d; d*c*y spans about one screen height
+   either way, hence the offset */
+static inline int faixa(int x, int y, int d, double c, int desl, int largura) {
+    int k = (int)lround(x + d * c * y) + desl;
+    return (k < 0) ? 0 : (k >= largura ? largura - 1 : k);
+}
+
+void autopilot_passo(Autopilot* a, GameState* game, int64_t now) {
+    if (now < a->prox_ms) return;
+    a->prox_ms = now + AUTO_PERIODO_MS;
+    const uint64_t t0 = prof_now_ns();
+
+    snapshot_publish(&a->canal, game);
+    const WorldSnapshot* w = snapshot_acquire(&a->canal);
+    const int sw = w->sw, fy = w->sh - w->ch - 1, bx = w->bateria_x;
+    const int vel_ms = game->cfg.ship_speed_ms;
+    const double c = (double)vel_ms / (vel_ms + ROCKET_STEP_MS);
+    const double voo_ms_linha = (double)ROCKET_STEP_MS * c;   /* closing speed is vr + vs */
+    const double passo_ms = (double)AUTO_PERIODO_MS / AUTO_MAX_PASSOS;
+
+    const int desl = w->sh + 1, largura = sw + 2 * desl + 1;
+    if (largura > a->largura) {
+        int* f = (int*)realloc(a->faixas, sizeof(int) * 3 * (size_t)largura);
+        if (!f) return;
+        a->faixas = f;
+        a->largura = largura;
+    }
+
+    /* Rockets in flight: climbing ones by lane, horizontal ones by reach */
+    int* faixas = a->faixas;
+    for (int i = 0; i < 3 * largura; i++) faixas[i] = -1;
+    int esq_max = -1, dir_min = sw;   /* a left-mover at x covers every ship left of x */
+    for (int i = 0; i < w->num_foguetes; i++) {
+        const int rx = w->foguete_x[i], ry = w->foguete_y[i], d = sinal(w->foguete_vx[i]);
+        if (w->foguete_vy[i] < 0) {
+            int* f = &faixas[(d + 1) * largura + faixa(rx, ry, d, c, desl, largura)];
+            if (ry > *f) *f = ry;
+        } else if (d < 0 && rx > esq_max) {
+            esq_max = rx;
+        } else if (d > 0 && rx < dir_min) {
+            dir_min = rx;
+        }
+    }
+
+    /* Every ship, every direction: cheapest feasible intercept, urgent first */
+    int alvo_x = -1;
+    DirecaoDisparo alvo_dir = DIR_VERTICAL;
+    double melhor = INFINITY;
+    for (int i = 0; i < w->num_naves; i++) {
+        const int sx = w->nave_x[i], sy = w->nave_y[i];
+        if (sy >= fy) continue;
+
+        /* Engaged: a lane through it holds a rocket still below it */
+        bool engajada = false;
+        for (int d = -1; d <= 1 && !engajada; d++) {
+            const int* f = &faixas[(d + 1) * largura];
+            int k = faixa(sx, sy, d, c, desl, largura);
+            engajada = f[k] > sy || (k > 0 && f[k - 1] > sy) || (k + 1 < largura && f[k + 1] > sy);
+        }
+        if (engajada) continue;
+
+        const double solo_ms = (double)(fy - sy) * vel_ms;
+        if (solo_ms >= melhor) continue;
+        const double voo_ms = (fy - sy) * voo_ms_linha;
+        for (int d = -1; d <= 1; d++) {
+            int x = (int)lround(sx + d * c * (sy - fy));
+            if (x < 0 || x >= sw) continue;
+            double mover_ms = abs(x - bx) * passo_ms;
+            double custo = solo_ms + mover_ms;
+            if (mover_ms + voo_ms >= solo_ms || custo >= melhor) continue;   /* lands first, or worse */
+            melhor = custo;
+            alvo_x = x;
+            alvo_dir = (d < 0) ? DIR_DIAGONAL_ESQ : (d > 0) ? DIR_DIAGONAL_DIR : DIR_VERTICAL;
+        }
+
+        /* Last resort: along the ground line, for ships inside its hit box */
+        if (fy - sy <= HIT_BOX && abs(sx - bx) > HIT_BOX && solo_ms < melhor &&
+            (sx < bx ? esq_max < sx : dir_min > sx)) {
+            double voo_h = (double)(abs(sx - bx) - HIT_BOX) * ROCKET_STEP_MS;
+            if (voo_h < solo_ms) {
+                melhor = solo_ms;
+                alvo_x = bx;
+                alvo_dir = (sx < bx) ? DIR_HORIZONTAL_ESQ : DIR_HORIZONTAL_DIR;
+            }
+        }
+    }
+
+    const uint64_t dt = prof_now_ns() - t0;
+    a->decisoes++;
+    a->ns_total += dt;
+    if (dt > a->ns_max) a->ns_max = dt;
+    prof_fim(PROF_FASE_AUTO, prof_on() ? t0 : 0);
+    if (alvo_x < 0) return;
+
+    /* Play it like a player: aim, step towards the column, fire when aligned */
+    if (alvo_dir != w->direcao) process_input(game, TECLA_DIR[alvo_dir]);
+    int x = bx;
+    for (int k = 0; k < AUTO_MAX_PASSOS && x != alvo_x; k++) {
+        int passo = (alvo_x > x) ? 1 : -1;
+        process_input(game, passo > 0 ? 'd' : 'a');
+        x += passo;
+    }
+    if (abs(alvo_x - x) <= 1 && w->lancadores_carregados > 0) {
+        process_input(game, ' ');
+        a->disparos++;
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef AUTOPILOT_H
+#define AUTOPILOT_H
+
+/**
+ * autopilot.h - Built-in gunner for load tests and benchmarks (--autopilot)
+ *
+ * Every AUTO_PERIODO_MS the autopilot takes its own world snapshot, solves
+ * an intercept for every ship and plays the best one through
+ * process_input, like a player would: a direction key, at most
+ * AUTO_MAX_PASSOS moves, then fire once aligned. Its shots are ordinary
+ * input, so they are recorded by --record and replay without it.
+ *
+ * Intercepts: a rocket fired from (bx, fy) with horizontal direction d
+ * (-1, 0, 1) climbs at the same speed vr it moves sideways, and a ship at
+ * (sx, sy) falls at vs. They meet when
+ *
+ *     sx + d*c*sy == bx + d*c*fy,     c = vr / (vr + vs)
+ *
+ * so each (ship, direction) pair has one battery column that hits it, and
+ * every rocket in flight sits on one "lane" of that invariant. Rockets are
+ * bucketed by lane (the lowest row per lane), which makes "is this ship
+ * already engaged" an O(1) lookup and one whole decision O(ships + rockets).
+ * Ships about to land can also be taken with a horizontal shot along the
+ * ground line. Speeds come from the profile (ship_speed_ms, ROCKET_STEP_MS).
+ *
+ * Deterministic: a pure function of the snapshot, so headless runs with a
+ * fixed seed reproduce exactly and double as a fire-path benchmark.
+ */
+
+#include "game.h"
+#include "snapshot.h"
+
+#define AUTO_PERIODO_MS  10    /* decision period */
+#define AUTO_MAX_PASSOS  2     /* battery moves per decision ("hand speed") */
+
+typedef struct Autopilot {
+    SnapChannel canal;         /* own frames, published and read on the caller's thread */
+    int64_t prox_ms;           /* next decision */
+    int* faixas;               /* [3][largura] lowest rocket row per lane, -1 if none */
+    int largura;
+    long decisoes, disparos;
+    uint64_t ns_total, ns_max; /* solver cost per decision */
+} Autopilot;
+
+int  autopilot_init(Autopilot* a, const GameState* game);   /* 0 on success */
+void autopilot_free(Autopilot* a);
+void autopilot_reset(Autopilot* a, const GameState* game);   /* after game_reset; keeps the totals */
+
+/* Decides and plays at most once per AUTO_PERIODO_MS; one thread only
+   (the main loop, or the headless loop) */
+void autopilot_passo(Autopilot* a, GameState* game, int64_t now);
+
+#endif /* AUTOPILOT_H */
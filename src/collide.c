@@ -0,0 +1,123 @@
+/**
+ * collide.c - Box-overlap kernels with runtime CPU dispatch
+ *
+ * Vector variants handle whole lanes and finish the tail with the scalar
+ * loop. The AVX2 body is compiled with a per-function target attribute, so
+ * the rest of the build keeps the baseline ISA and older CPUs never execute
+ * it.
+ */
+#include "collide.h"
+#include <stdlib.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COLLIDE_X86 1
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#define COLLIDE_NEON 1
+#endif
+
+static uint64_t box64_scalar(const int* xs, const int* ys, int n, int x, int y, int r) {
+    uint64_t m = 0;
+    for (int i = 0; i < n; i++)
+        if (abs(xs[i] - x) <= r && abs(ys[i] - y) <= r) m |= (uint64_t)1 << i;
+    return m;
+}
+
+static uint64_t tail(uint64_t m, int done, const int* xs, const int* ys, int n, int x, int y, int r) {
+    if (done < n) m |= box64_scalar(xs + done, ys + done, n - done, x, y, r) << done;
+    return m;
+}
+
+#ifdef COLLIDE_X86
+#if defined(__SSE2__)
+/* |d| <= r  <=>  !(d > r) && !(-r > d) */
+static uint64_t box64_sse2(const int* xs, const int* ys, int n, int x, int y, int r) {
+    const __m128i vx = _mm_set1_epi32(x), vy = _mm_set1_epi32(y);
+    const __m128i hi = _mm_set1_epi32(r), lo = _mm_set1_epi32(-r);
+    uint64_t m = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i dx = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(xs + i)), vx);
+        __m128i dy = _mm_sub_epi32(_mm_loadu_si128((const __m128i*)(ys + i)), vy);
+        __m128i out = _mm_or_si128(_mm_or_si128(_mm_cmpgt_epi32(dx, hi), _mm_cmpgt_epi32(lo, dx)),
+                                   _mm_or_si128(_mm_cmpgt_epi32(dy, hi), _mm_cmpgt_epi32(lo, dy)));
+        unsigned bits = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(out)) ^ 0xFu;
+        m |= (uint64_t)bits << i;
+    }
+    return tail(m, i, xs, ys, n, x, y, r);
+}
+#endif
+
+__attribute__((target("avx2")))
+static uint64_t box64_avx2(const int* xs, const int* ys, int n, int x, int y, int r) {
+    const __m256i vx = _mm256_set1_epi32(x), vy = _mm256_set1_epi32(y);
+    const __m256i hi = _mm256_set1_epi32(r), lo = _mm256_set1_epi32(-r);
+    uint64_t m = 0;
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i dx = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(xs + i)), vx);
+        __m256i dy = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i*)(ys + i)), vy);
+        __m256i out = _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(dx, hi), _mm256_cmpgt_epi32(lo, dx)),
+                                      _mm256_or_si256(_mm256_cmpgt_epi32(dy, hi), _mm256_cmpgt_epi32(lo, dy)));
+        unsigned bits = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(out)) ^ 0xFFu;
+        m |= (uint64_t)bits << i;
+    }
+    return tail(m, i, xs, ys, n, x, y, r);
+}
+#endif /* COLLIDE_X86 */
+
+#ifdef COLLIDE_NEON
+static uint64_t box64_neon(const int* xs, const int* ys, int n, int x, int y, int r) {
+    const int32x4_t vx = vdupq_n_s32(x), vy = vdupq_n_s32(y);
+    const uint32x4_t vr = vdupq_n_u32((uint32_t)r);
+    const uint32x4_t lane = {1, 2, 4, 8};
+    uint64_t m = 0;
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        uint32x4_t ax = vreinterpretq_u32_s32(vabdq_s32(vld1q_s32(xs + i), vx));
+        uint32x4_t ay = vreinterpretq_u32_s32(vabdq_s32(vld1q_s32(ys + i), vy));
+        uint32x4_t in = vandq_u32(vcleq_u32(ax, vr), vcleq_u32(ay, vr));
+        m |= (uint64_t)vaddvq_u32(vandq_u32(in, lane)) << i;
+    }
+    return tail(m, i, xs, ys, n, x, y, r);
+}
+#endif
+
+collide_box_fn collide_box64 = box64_scalar;
+static const char* s_impl = "scalar";
+
+void collide_init(void) {
+#ifdef COLLIDE_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { collide_box64 = box64_avx2; s_impl = "avx2"; return; }
+#if defined(__SSE2__)
+    collide_box64 = box64_sse2; s_impl = "sse2";
+    return;
+#endif
+#endif
+#ifdef COLLIDE_NEON
+    collide_box64 = box64_neon; s_impl = "neon";
+    return;
+#endif
+}
+
+const char* collide_impl_name(void) { return s_impl; }
+
+int collide_variantes(collide_box_fn* fns, const char** nomes, int max) {
+    int n = 0;
+#define VARIANTE(f, nome) do { if (n < max) { fns[n] = (f); nomes[n] = (nome); n++; } } while (0)
+    VARIANTE(box64_scalar, "scalar");
+#ifdef COLLIDE_X86
+#if defined(__SSE2__)
+    VARIANTE(box64_sse2, "sse2");
+#endif
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) VARIANTE(box64_avx2, "avx2");
+#endif
+#ifdef COLLIDE_NEON
+    VARIANTE(box64_neon, "neon");
+#endif
+#undef VARIANTE
+    return n;
+}
@@ -0,0 +1,28 @@
+#ifndef COLLIDE_H
+#define COLLIDE_H
+
+/**
+ * collide.h - Batched box-overlap kernel
+ *
+ * Tests one point against up to 64 packed (x, y) positions and returns a
+ * hit mask: bit i set <=> |xs[i] - x| <= r && |ys[i] - y| <= r. The best
+ * implementation for the running CPU (AVX2 / SSE2 / NEON / scalar) is
+ * picked once by collide_init(); all of them produce identical masks.
+ */
+
+#include <stdint.h>
+
+#define COLLIDE_BATCH 64
+
+typedef uint64_t (*collide_box_fn)(const int* xs, const int* ys, int n, int x, int y, int r);
+
+extern collide_box_fn collide_box64;
+
+void collide_init(void);
+const char* collide_impl_name(void);
+
+/* Every variant the running CPU can execute, scalar first (at most max);
+   returns how many. For equivalence checks (bench/micro.c). */
+int collide_variantes(collide_box_fn* fns, const char** nomes, int max);
+
+#endif /* COLLIDE_H */
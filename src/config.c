@@ -0,0 +1,162 @@
+/**
+ * config.c - Difficulty profile file parser (see config.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "config.h"
+#include "waves.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+typedef struct {
+    const char* chave;
+    size_t off;             /* int field in DifficultyConfig */
+    int min, max;
+} Campo;
+
+static const Campo CAMPOS[] = {
+    { "launchers",     offsetof(DifficultyConfig, launchers),     1, 1024 },
+    { "reload_ms",     offsetof(DifficultyConfig, reload_ms),     1, 3600000 },
+    { "ships_total",   offsetof(DifficultyConfig, ships_total),   1, 10000000 },
+    { "ship_speed_ms", offsetof(DifficultyConfig, ship_speed_ms), 1, 60000 },
+    { "spawn_min_ms",  offsetof(DifficultyConfig, spawn_min_ms),  1, 3600000 },
+    { "spawn_max_ms",  offsetof(DifficultyConfig, spawn_max_ms),  1, 3600000 },
+    { "max_ships",     offsetof(DifficultyConfig, max_naves),     0, POOL_LIMIT },
+    { "max_rockets",   offsetof(DifficultyConfig, max_foguetes),  0, POOL_LIMIT },
+    { "formation_max", offsetof(DifficultyConfig, formacao_max),  0, ONDA_FORMACAO_MAX },
+    { "swarm_ships",   offsetof(DifficultyConfig, enxame),        0, POOL_LIMIT },
+};
+#define NUM_CAMPOS (int)(sizeof(CAMPOS) / sizeof(CAMPOS[0]))
+
+static void definir_nome(PerfilTabela* t, int i, const char* nome) {
+    snprintf(t->nomes[i], CONFIG_NOME_MAX, "%s", nome);
+    t->perfis[i].name = t->nomes[i];
+}
+
+/* Copies profile `de` over `para`, keeping para's id and name */
+static void copiar_perfil(PerfilTabela* t, int para, int de) {
+    DifficultyConfig c = t->perfis[de];
+    c.id = para;
+    c.name = t->nomes[para];
+    t->perfis[para] = c;
+}
+
+void config_padrao(PerfilTabela* t) {
+    for (int i = 0; i < NUM_DIFFS; i++) {
+        t->perfis[i] = DIFFS[i];
+        definir_nome(t, i, DIFFS[i].name);
+    }
+    t->num = NUM_DIFFS;
+}
+
+int config_procurar(const PerfilTabela* t, const char* s) {
+    if (!s || !*s) return -1;
+    char* fim;
+    long n = strtol(s, &fim, 10);
+    if (*fim == '\0') return (n >= 0 && n < t->num) ? (int)n : -1;
+    for (int i = 0; i < t->num; i++)
+        if (strcasecmp(t->nomes[i], s) == 0) return i;
+    return -1;
+}
+
+static char* aparar(char* s) {
+    while (isspace((unsigned char)*s)) s++;
+    char* e = s + strlen(s);
+    while (e > s && isspace((unsigned char)e[-1])) *--e = '\0';
+    return s;
+}
+
+static const char* validar(const DifficultyConfig* c) {
+    if (c->spawn_max_ms < c->spawn_min_ms) return "spawn_max_ms < spawn_min_ms";
+    return NULL;
+}
+
+const char* config_validar(const DifficultyConfig* c) {
+    for (int k = 0; k < NUM_CAMPOS; k++) {
+        int v = *(const int*)((const char*)c + CAMPOS[k].off);
+        if (v < CAMPOS[k].min || v > CAMPOS[k].max) return CAMPOS[k].chave;
+    }
+    return validar(c);
+}
+
+int config_carregar(PerfilTabela* t, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "Cannot open config %s\n", path); return -1; }
+
+    char line[256];
+    int lineno = 0, atual = -1, inicio = 0;   /* section being filled, its line */
+    unsigned vistos = 0;                      /* keys it has set: bit k = CAMPOS[k], NUM_CAMPOS = base */
+    const char* erro = NULL;
+
+    while (fgets(line, sizeof line, f)) {
+        lineno++;
+        char* p = line;
+        for (char* c = p; *c; c++) if (*c == '#' || *c == ';') { *c = '\0'; break; }
+        p = aparar(p);
+        if (!*p) continue;
+
+        if (*p == '[') {
+            char* fim = strchr(p, ']');
+            if (!fim || fim[1] != '\0') { erro = "bad section header"; break; }
+            *fim = '\0';
+            char* nome = aparar(p + 1);
+            if (!*nome || strlen(nome) >= CONFIG_NOME_MAX) { erro = "bad profile name"; break; }
+            if (atual >= 0 && (erro = validar(&t->perfis[atual])) != NULL) { lineno = inicio; break; }
+
+            if (isdigit((unsigned char)*nome)) { erro = "profile names can't start with a digit"; break; }
+
+            atual = config_procurar(t, nome);
+            if (atual < 0) {
+                if (t->num == CONFIG_MAX_PERFIS) { erro = "too many profiles"; break; }
+                atual = t->num++;
+                definir_nome(t, atual, nome);
+                copiar_perfil(t, atual, 1);          /* new profiles start from Medium */
+            }
+            inicio = lineno;
+            vistos = 0;
+            continue;
+        }
+
+        char* eq = strchr(p, '=');
+        if (!eq) { erro = "expected key = value"; break; }
+        if (atual < 0) { erro = "key outside a [profile] section"; break; }
+        *eq = '\0';
+        char* chave = aparar(p);
+        char* valor = aparar(eq + 1);
+
+        int k = 0;
+        while (k < NUM_CAMPOS && strcmp(CAMPOS[k].chave, chave) != 0) k++;
+        if (k == NUM_CAMPOS && strcmp(chave, "base") != 0) { erro = "unknown key"; break; }
+        if (vistos & (1u << k)) { erro = "duplicate key"; break; }
+        vistos |= 1u << k;
+
+        if (k == NUM_CAMPOS) {
+            int b = config_procurar(t, valor);
+            if (b < 0) { erro = "unknown base profile"; break; }
+            copiar_perfil(t, atual, b);
+            continue;
+        }
+
+        char* fim;
+        errno = 0;
+        long v = strtol(valor, &fim, 10);
+        if (errno || fim == valor || *fim || v < CAMPOS[k].min || v > CAMPOS[k].max) {
+            erro = "bad or out-of-range value";
+            break;
+        }
+        *(int*)((char*)&t->perfis[atual] + CAMPOS[k].off) = (int)v;
+    }
+    if (!erro && atual >= 0 && (erro = validar(&t->perfis[atual])) != NULL) lineno = inicio;
+    fclose(f);
+
+    if (erro) {
+        fprintf(stderr, "%s:%d: %s\n", path, lineno, erro);
+        return -1;
+    }
+    return 0;
+}
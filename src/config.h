@@ -0,0 +1,55 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+/**
+ * config.h - Difficulty profiles loaded from a file (--config)
+ *
+ * The table starts as the built-in DIFFS presets; a config file adds or
+ * replaces profiles without a rebuild. One section per profile:
+ *
+ *     # comment
+ *     [Stress]
+ *     base          = hard     ; start from another profile (default Medium)
+ *     launchers     = 40
+ *     reload_ms     = 300
+ *     ships_total   = 5000
+ *     ship_speed_ms = 200
+ *     spawn_min_ms  = 5
+ *     spawn_max_ms  = 20
+ *     max_ships     = 4096     ; pool capacities (0 = defaults)
+ *     max_rockets   = 2048
+ *     formation_max = 8        ; waves (see waves.h): 1 = single ships only
+ *     swarm_ships   = 500      ; 0 = no swarm waves
+ *
+ * A section named like an existing profile (case-insensitive) edits it in
+ * place, keeping the keys it doesn't set; any other name is appended with
+ * the next id, starting from Medium. Keys apply in file order, so `base`
+ * normally comes first; a key given twice in one section is an error.
+ * Each profile is validated when its section ends.
+ */
+
+#include "game.h"
+
+#define CONFIG_MAX_PERFIS 64
+#define CONFIG_NOME_MAX   24
+
+typedef struct {
+    DifficultyConfig perfis[CONFIG_MAX_PERFIS];   /* perfis[i].id == i */
+    char nomes[CONFIG_MAX_PERFIS][CONFIG_NOME_MAX];
+    int num;
+} PerfilTabela;
+
+/* The built-in presets only */
+void config_padrao(PerfilTabela* t);
+
+/* Adds the profiles in `path`; 0, or -1 with a file:line message on stderr */
+int  config_carregar(PerfilTabela* t, const char* path);
+
+/* Checks a profile built elsewhere (a replay header) against the same
+   ranges a config file gets; NULL, or the offending key or rule */
+const char* config_validar(const DifficultyConfig* c);
+
+/* Profile index from a number or a name (case-insensitive), or -1 */
+int  config_procurar(const PerfilTabela* t, const char* s);
+
+#endif /* CONFIG_H */
@@ -0,0 +1,56 @@
+/**
+ * events.c - Lock-free MPSC event ring (see events.h)
+ */
+#include "events.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+int events_init(EventRing* r, size_t min_cap) {
+    size_t cap = 16;
+    while (cap < min_cap) cap <<= 1;
+    r->cel = (EventoCelula*)malloc(sizeof(EventoCelula) * cap);
+    if (!r->cel) return -1;
+    for (size_t i = 0; i < cap; i++) atomic_init(&r->cel[i].seq, i);
+    r->mask = cap - 1;
+    atomic_init(&r->cauda, 0);
+    r->cabeca = 0;
+    return 0;
+}
+
+void events_free(EventRing* r) {
+    free(r->cel);
+    r->cel = NULL;
+}
+
+bool events_push(EventRing* r, Evento ev) {
+    size_t pos = atomic_load_explicit(&r->cauda, memory_order_relaxed);
+    EventoCelula* c;
+    for (;;) {
+        c = &r->cel[pos & r->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            /* slot free for this lap: claim it */
+            if (atomic_compare_exchange_weak_explicit(&r->cauda, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed))
+                break;
+        } else if (dif < 0) {
+            return false;   /* consumer hasn't freed it yet: full */
+        } else {
+            pos = atomic_load_explicit(&r->cauda, memory_order_relaxed);
+        }
+    }
+    c->ev = ev;
+    atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+    return true;
+}
+
+bool events_pop(EventRing* r, Evento* ev) {
+    EventoCelula* c = &r->cel[r->cabeca & r->mask];
+    size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+    if ((intptr_t)seq - (intptr_t)(r->cabeca + 1) < 0) return false;
+    *ev = c->ev;
+    atomic_store_explicit(&c->seq, r->cabeca + r->mask + 1, memory_order_release);
+    r->cabeca++;
+    return true;
+}
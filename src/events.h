@@ -0,0 +1,51 @@
+#ifndef EVENTS_H
+#define EVENTS_H
+
+/**
+ * events.h - Lock-free MPSC ring of gameplay events
+ *
+ * Simulation code (entity threads, the tick loop, the input thread) pushes
+ * kills, ground arrivals and shots; one consumer drains the ring once per
+ * frame or headless tick and applies scoring in a batch (see
+ * game_drenar_eventos). Bounded array queue after Vyukov: every cell
+ * carries a sequence number, producers claim a slot with one CAS on the
+ * tail, and the single consumer needs no atomic read-modify-write at all.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    EV_ABATE,       /* ship destroyed at (x, y): score + explosion */
+    EV_CHEGADA,     /* ship reached the ground: breaks the streak */
+    EV_DISPARO      /* rocket fired */
+} EventoTipo;
+
+typedef struct Evento {
+    int tipo;       /* EventoTipo */
+    int x, y;
+} Evento;
+
+typedef struct {
+    _Atomic size_t seq;
+    Evento ev;
+} EventoCelula;
+
+typedef struct EventRing {
+    EventoCelula* cel;
+    size_t mask;                  /* capacity - 1 (power of two) */
+    _Atomic size_t cauda;         /* next slot producers claim */
+    size_t cabeca;                /* next slot the consumer reads */
+} EventRing;
+
+int  events_init(EventRing* r, size_t min_cap);   /* 0 on success */
+void events_free(EventRing* r);
+
+/* Any thread; false if the ring is full */
+bool events_push(EventRing* r, Evento ev);
+
+/* Consumer thread only; false if empty */
+bool events_pop(EventRing* r, Evento* ev);
+
+#endif /* EVENTS_H */
@@ -1,11 +1,20 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "game.h"
 #include "threads.h"
+#include "collide.h"
+#include "snapshot.h"
+#include "events.h"
+#include "pool.h"
+#include "replay.h"
+#include "prof.h"
+#include "waves.h"
 
 /* Default metrics until renderer measures terminal */
 #define DEF_W 120
@@ -14,36 +23,193 @@
 #define CTRL_H 2
 
 /* Difficulty table:
-   Easy:   30 ships, spawn 2-3s, 4 launchers, 2500ms reload, ships slower
-   Medium: 40 ships, spawn 2s,   7 launchers, 1500ms reload, medium speed
-   Hard:   60 ships, spawn 1-2s, 12 launchers, 800ms reload, faster ships
+   Easy:   30 ships, spawn 2-3s, 4 launchers, 2500ms reload, ships slower, pairs
+   Medium: 40 ships, spawn 2s,   7 launchers, 1500ms reload, medium speed, up to 3
+   Hard:   60 ships, spawn 1-2s, 12 launchers, 800ms reload, faster ships, up to 5
+           and a 20-ship swarm every 8th wave
 */
-static const DifficultyConfig DIFFS[3] = {
-    {0, "Easy",   4, 2500, 30, 800, 2000, 3000},
-    {1, "Medium", 7, 1500, 40, 600, 2000, 2000},
-    {2, "Hard",  12,  800, 60, 450, 1000, 2000},
+const DifficultyConfig DIFFS[NUM_DIFFS] = {
+    {0, "Easy",   4, 2500, 30, 800, 2000, 3000, 0, 0, 2, 0},
+    {1, "Medium", 7, 1500, 40, 600, 2000, 2000, 0, 0, 3, 0},
+    {2, "Hard",  12,  800, 60, 450, 1000, 2000, 0, 0, 5, 20},
 };
 
-void game_init(GameState* game, int dificuldade) {
+static inline uint64_t metricas_pack(int w, int h, int hud, int ch) {
+    return (uint64_t)(w & 0xFFFF) | (uint64_t)(h & 0xFFFF) << 16 |
+           (uint64_t)(hud & 0xFFFF) << 32 | (uint64_t)(ch & 0xFFFF) << 48;
+}
+
+/* Arena carving: every block starts on a cache line so columns can be
+   loaded with aligned vector loads. With base == NULL only sizes. */
+#define ARENA_ALIGN 64
+
+static void* arena_carve(char* base, size_t* off, size_t bytes) {
+    size_t at = *off;
+    *off = (at + bytes + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    return base ? base + at : NULL;
+}
+
+static void cols_carve(EntityCols* c, char* base, size_t* off, int cap) {
+    size_t n = (size_t)cap;
+    c->t0_ms = (int64_t*)arena_carve(base, off, sizeof(int64_t) * n);
+    c->id  = (int*)arena_carve(base, off, sizeof(int) * n);
+    c->pos = (int*)arena_carve(base, off, sizeof(int) * n);
+    c->x   = (int*)arena_carve(base, off, sizeof(int) * n);
+    c->y   = (int*)arena_carve(base, off, sizeof(int) * n);
+    c->ox  = (int32_t*)arena_carve(base, off, sizeof(int32_t) * n);
+    c->oy  = (int32_t*)arena_carve(base, off, sizeof(int32_t) * n);
+    c->vx  = (int32_t*)arena_carve(base, off, sizeof(int32_t) * n);
+    c->vy  = (int32_t*)arena_carve(base, off, sizeof(int32_t) * n);
+    c->num = 0;
+}
+
+/* Append a live entity at the centre of cell (x, y) at time t0, moving at
+   (vx, vy) 16.16 cells per second; returns its dense index */
+static int cols_add(EntityCols* c, int id, int x, int y, int32_t vx, int32_t vy, int64_t t0) {
+    int p = c->num++;
+    c->id[p] = id;
+    c->x[p] = x;   c->y[p] = y;
+    c->ox[p] = FX_CENTRO(x); c->oy[p] = FX_CENTRO(y);
+    c->vx[p] = vx; c->vy[p] = vy;
+    c->t0_ms[p] = t0;
+    c->pos[id] = p;
+    return p;
+}
+
+/* Per axis: ms from t0 until the displacement reaches the next cell edge.
+   Mirrors fx_celula's truncation, so the cell has changed at that time. */
+static int64_t eixo_proxima_ms(int32_t o, int32_t v, int cel) {
+    if (v == 0) return INT64_MAX;
+    int64_t dist = (v > 0) ? ((int64_t)(cel + 1) << FX_SHIFT) - o
+                           : (int64_t)o - ((int64_t)cel << FX_SHIFT) + 1;
+    int64_t av = (v > 0) ? v : -(int64_t)v;
+    return (dist * 1000 + av - 1) / av;
+}
+
+int64_t col_proxima_ms(const EntityCols* c, int p) {
+    int64_t ax = eixo_proxima_ms(c->ox[p], c->vx[p], c->x[p]);
+    int64_t ay = eixo_proxima_ms(c->oy[p], c->vy[p], c->y[p]);
+    int64_t dt = (ax < ay) ? ax : ay;
+    return (dt == INT64_MAX) ? INT64_MAX : c->t0_ms[p] + dt;
+}
+
+/* Swap-remove: the last live entry fills the hole */
+static void cols_remove(EntityCols* c, int id) {
+    int p = c->pos[id];
+    if (p < 0) return;
+    int last = --c->num;
+    if (p != last) {
+        int moved = c->id[last];
+        c->id[p] = moved;
+        c->x[p] = c->x[last];   c->y[p] = c->y[last];
+        c->ox[p] = c->ox[last]; c->oy[p] = c->oy[last];
+        c->vx[p] = c->vx[last]; c->vy[p] = c->vy[last];
+        c->t0_ms[p] = c->t0_ms[last];
+        c->pos[moved] = p;
+    }
+    c->pos[id] = -1;
+}
+
+int game_init(GameState* game, const GameOptions* opts) {
     memset(game, 0, sizeof(GameState));
+    collide_init();
+    int dificuldade = opts->dificuldade;
 
     /* Initial dynamic metrics (renderer will overwrite on first frame) */
-    game->screen_width  = DEF_W;
-    game->screen_height = DEF_H;
-    game->hud_height = HUD_H;
-    game->controls_height = CTRL_H;
+    atomic_init(&game->metricas, metricas_pack(DEF_W, DEF_H, HUD_H, CTRL_H));
 
-    game->dificuldade = (dificuldade < 0 || dificuldade > 2) ? 1 : dificuldade;
-    game->cfg = DIFFS[game->dificuldade];
+    if (opts->perfil) {
+        game->cfg = *opts->perfil;
+    } else {
+        game->cfg = DIFFS[(dificuldade < 0 || dificuldade >= NUM_DIFFS) ? 1 : dificuldade];
+    }
+    game->dificuldade = game->cfg.id;
+    if (opts->ships > 0) game->cfg.ships_total = opts->ships;
+    if (opts->spawn_ms > 0) game->cfg.spawn_min_ms = game->cfg.spawn_max_ms = opts->spawn_ms;
+
+    game->sim_mode = opts->headless ? SIM_TICK : opts->sim_mode;
+    game->varrido  = opts->varrido && game->sim_mode == SIM_TICK;
+    game->tick_ms  = (opts->tick_ms > 0) ? opts->tick_ms : DEF_TICK_MS;
+    game->fps      = (opts->fps > 0) ? opts->fps : 0;
+    game->frames_rendered = game->frames_skipped = 0;
 
     game->num_lancadores = game->cfg.launchers;
     game->tempo_recarga  = game->cfg.reload_ms;
     game->naves_total    = game->cfg.ships_total;
 
+    game->cap_naves    = (opts->max_naves > 0)       ? opts->max_naves :
+                         (game->cfg.max_naves > 0)    ? game->cfg.max_naves    : DEF_MAX_NAVES;
+    game->cap_foguetes = (opts->max_foguetes > 0)    ? opts->max_foguetes :
+                         (game->cfg.max_foguetes > 0) ? game->cfg.max_foguetes : DEF_MAX_FOGUETES;
+    if (game->cap_naves > POOL_LIMIT || game->cap_foguetes > POOL_LIMIT) return -1;
+
+    /* One arena: cold structs, hot columns, launchers and free stacks.
+       Two passes over the same carve list: the first only sizes it. */
+    char* arena = NULL;
+    for (int pass = 0; pass < 2; pass++) {
+        size_t off = 0;
+        game->naves           = (Nave*)arena_carve(arena, &off, sizeof(Nave) * (size_t)game->cap_naves);
+        game->foguetes        = (Foguete*)arena_carve(arena, &off, sizeof(Foguete) * (size_t)game->cap_foguetes);
+        game->lancadores      = (Lancador*)arena_carve(arena, &off, sizeof(Lancador) * (size_t)game->num_lancadores);
+        game->recarga_heap    = (int*)arena_carve(arena, &off, sizeof(int) * (size_t)game->num_lancadores);
+        game->recarga_pos     = (int*)arena_carve(arena, &off, sizeof(int) * (size_t)game->num_lancadores);
+        game->naves_livres    = (int*)arena_carve(arena, &off, sizeof(int) * (size_t)game->cap_naves);
+        game->foguetes_livres = (int*)arena_carve(arena, &off, sizeof(int) * (size_t)game->cap_foguetes);
+        game->varre_fim       = (int64_t*)arena_carve(arena, &off, sizeof(int64_t) * (size_t)game->cap_naves);
+        game->tick_ev         = (Evento*)arena_carve(arena, &off, sizeof(Evento) * (size_t)game->cap_naves);
+        cols_carve(&game->col_naves, arena, &off, game->cap_naves);
+        cols_carve(&game->col_foguetes, arena, &off, game->cap_foguetes);
+        if (pass == 0) {
+            arena = (char*)aligned_alloc(ARENA_ALIGN, off);
+            if (!arena) return -1;
+            memset(arena, 0, off);
+        }
+    }
+    game->arena = arena;
+    for (int i = 0; i < game->cap_naves; i++)    game->col_naves.pos[i] = -1;
+    for (int i = 0; i < game->cap_foguetes; i++) game->col_foguetes.pos[i] = -1;
+
+    /* Free stacks popped from the top: lowest slot index is handed out first */
+    for (int i = 0; i < game->cap_naves; i++)
+        game->naves_livres[i] = game->cap_naves - 1 - i;
+    game->num_naves_livres = game->cap_naves;
+    for (int i = 0; i < game->cap_foguetes; i++)
+        game->foguetes_livres[i] = game->cap_foguetes - 1 - i;
+    game->num_foguetes_livres = game->cap_foguetes;
+
     for (int i = 0; i < game->num_lancadores; i++) {
         game->lancadores[i].tem_foguete = false;
         game->lancadores[i].direcao = DIR_VERTICAL;
+        game->recarga_pos[i] = -1;
     }
+    game->num_recarga = 0;
+
+    if (grid_init(&game->grid_naves, game->cap_naves, DEF_W, DEF_H) != 0) goto falha_arena;
+    if (grid_init(&game->grid_foguetes, game->cap_foguetes, DEF_W, DEF_H) != 0) goto falha_grid_naves;
+    game->snap_render = (SnapChannel*)malloc(sizeof(SnapChannel));
+    if (!game->snap_render || snapshot_init(game->snap_render, game->cap_naves, game->cap_foguetes) != 0) {
+        free(game->snap_render);
+        goto falha_grid_foguetes;
+    }
+    /* Event ring: every slot lifetime ends in at most one event and every
+       shot adds one, so this covers a full drain interval with headroom */
+    game->eventos = (EventRing*)malloc(sizeof(EventRing));
+    if (!game->eventos ||
+        events_init(game->eventos, 2 * ((size_t)game->cap_naves + (size_t)game->cap_foguetes) + 64) != 0) {
+        free(game->eventos);
+        goto falha_snap;
+    }
+    game->ondas = (Ondas*)malloc(sizeof(Ondas));
+    if (!game->ondas || ondas_init(game->ondas) != 0) {
+        free(game->ondas);
+        goto falha_eventos;
+    }
+    /* --swept: one hit or landing per live entity before the list grows */
+    if (game->varrido && sim_varrer_reservar(game, game->cap_naves + game->cap_foguetes) != 0) goto falha_ondas;
+    if (pipe(game->wake_fd) != 0) goto falha_varre;
+    fcntl(game->wake_fd[1], F_SETFL, O_NONBLOCK);
+    atomic_init(&game->lancadores_carregados, 0);
+    atomic_init(&game->resize_pedido, 0);
 
     pthread_mutex_init(&game->mutex_naves, NULL);
     pthread_mutex_init(&game->mutex_foguetes, NULL);
@@ -51,27 +217,71 @@ void game_init(GameState* game, int dificuldade) {
     pthread_mutex_init(&game->mutex_lancadores, NULL);
     pthread_mutex_init(&game->mutex_render, NULL);
 
-    pthread_cond_init(&game->cond_lancador_vazio, NULL);
-    pthread_cond_init(&game->cond_game_over, NULL);
-
-    game->pontuacao = 0;
-    game->naves_destruidas = 0;
-    game->naves_chegaram = 0;
-    game->naves_spawned = 0;
+    /* The reloader, frame and tick loops sleep until absolute
+       CLOCK_MONOTONIC deadlines */
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&game->cond_lancador_vazio, &ca);
+    pthread_cond_init(&game->cond_game_over, &ca);
+    pthread_condattr_destroy(&ca);
+
+    atomic_init(&game->pontuacao, 0);
+    atomic_init(&game->naves_destruidas, 0);
+    atomic_init(&game->naves_chegaram, 0);
+    atomic_init(&game->naves_spawned, 0);
     game->num_naves_ativas = 0;
     game->num_foguetes_ativos = 0;
 
-    game->shots_fired = 0;
-    game->shots_hit = 0;
-    game->current_streak = 0;
-    game->best_streak = 0;
-    game->start_time = time(NULL);
-    game->elapsed_sec = 0;
+    atomic_init(&game->shots_fired, 0);
+    atomic_init(&game->shots_hit, 0);
+    atomic_init(&game->current_streak, 0);
+    atomic_init(&game->best_streak, 0);
+    game->relogio_virtual = opts->headless;
+    game->relogio_ms = 0;
+    game->rng = opts->seed ? opts->seed : ((uint64_t)time(NULL) << 20) ^ (uint64_t)getpid();
+    game->semente = game->rng;
+    game->start_ms = game_now_ms(game);
+    game->sim_t_ms = game->start_ms;
+    game->passo_min_ms = (game->cfg.ship_speed_ms < ROCKET_STEP_MS) ? game->cfg.ship_speed_ms : ROCKET_STEP_MS;
+    atomic_init(&game->elapsed_sec, 0);
+    ondas_iniciar(game->ondas, game);
+
+    /* Launchers start empty: all of them begin reloading now */
+    for (int i = 0; i < game->num_lancadores; i++)
+        recarga_agendar(game, i, game->start_ms + game->tempo_recarga);
 
     atomic_init(&game->game_over, false);
+    atomic_init(&game->encerrado, false);
 
-    game->bateria_x = game->screen_width / 2;
+    game->bateria_x = DEF_W / 2;
     game->direcao_atual = DIR_VERTICAL;
+    return 0;
+
+    /* Partial init: release what was acquired, in reverse */
+falha_varre:
+    free(game->varre_imp);
+    game->varre_imp = NULL;
+falha_ondas:
+    ondas_free(game->ondas);
+    free(game->ondas);
+    game->ondas = NULL;
+falha_eventos:
+    events_free(game->eventos);
+    free(game->eventos);
+    game->eventos = NULL;
+falha_snap:
+    snapshot_free(game->snap_render);
+    free(game->snap_render);
+    game->snap_render = NULL;
+falha_grid_foguetes:
+    grid_free(&game->grid_foguetes);
+falha_grid_naves:
+    grid_free(&game->grid_naves);
+falha_arena:
+    free(game->arena);
+    game->arena = NULL;
+    return -1;
 }
 
 void game_cleanup(GameState* game) {
@@ -83,207 +293,505 @@ void game_cleanup(GameState* game) {
 
     pthread_cond_destroy(&game->cond_lancador_vazio);
     pthread_cond_destroy(&game->cond_game_over);
+
+    grid_free(&game->grid_naves);
+    grid_free(&game->grid_foguetes);
+    free(game->arena);
+    game->arena = NULL;
+    free(game->varre_imp);
+    game->varre_imp = NULL;
+    snapshot_free(game->snap_render);
+    free(game->snap_render);
+    game->snap_render = NULL;
+    events_free(game->eventos);
+    free(game->eventos);
+    game->eventos = NULL;
+    if (game->ondas) ondas_free(game->ondas);
+    free(game->ondas);
+    game->ondas = NULL;
+    if (game->pool) {
+        pool_free(game->pool);
+        free(game->pool);
+        game->pool = NULL;
+    }
+    close(game->wake_fd[0]);
+    close(game->wake_fd[1]);
 }
 
-void criar_nave(GameState* game) {
-    pthread_mutex_lock(&game->mutex_estado);
-    if (game->naves_spawned >= game->naves_total) {
-        pthread_mutex_unlock(&game->mutex_estado);
-        return;
+void game_resize(GameState* game, int w, int h) {
+    /* lock order: naves -> foguetes -> estado */
+    LOCK(game, naves);
+    const EntityCols* cn = &game->col_naves;
+    if (grid_resize(&game->grid_naves, w, h) == 0) {
+        for (int p = 0; p < cn->num; p++)
+            grid_insert(&game->grid_naves, cn->id[p], cn->x[p], cn->y[p]);
     }
-    /* Reserve spawn slot immediately to prevent race */
-    game->naves_spawned++;
-    int w = game->screen_width;
-    int hud = game->hud_height;
-    pthread_mutex_unlock(&game->mutex_estado);
-
-    pthread_mutex_lock(&game->mutex_naves);
-    if (game->num_naves_ativas >= MAX_NAVES) {
-        pthread_mutex_unlock(&game->mutex_naves);
-        /* Rollback spawn count since we can't actually spawn */
-        pthread_mutex_lock(&game->mutex_estado);
-        game->naves_spawned--;
-        pthread_mutex_unlock(&game->mutex_estado);
-        return;
+    LOCK(game, foguetes);
+    const EntityCols* cf = &game->col_foguetes;
+    if (grid_resize(&game->grid_foguetes, w, h) == 0) {
+        for (int p = 0; p < cf->num; p++)
+            grid_insert(&game->grid_foguetes, cf->id[p], cf->x[p], cf->y[p]);
     }
-    int idx = -1;
-    for (int i = 0; i < MAX_NAVES; i++) {
-        if (!game->naves[i].ativa) { idx = i; break; }
+    UNLOCK(game, foguetes);
+    UNLOCK(game, naves);
+
+    Metricas m = game_metricas(game);
+    atomic_store_explicit(&game->metricas, metricas_pack(w, h, m.hud, m.ch), memory_order_release);
+
+    LOCK(game, estado);
+    if (game->bateria_x >= w) game->bateria_x = w - 1;
+    UNLOCK(game, estado);
+
+    replay_resize(game, w, h);
+}
+
+void game_request_resize(GameState* game, int w, int h) {
+    atomic_store_explicit(&game->resize_pedido, ((uint32_t)w << 16) | (uint32_t)(h & 0xFFFF),
+                          memory_order_release);
+}
+
+void game_apply_resize(GameState* game) {
+    uint32_t r = atomic_exchange_explicit(&game->resize_pedido, 0, memory_order_acquire);
+    if (r) game_resize(game, (int)(r >> 16), (int)(r & 0xFFFF));
+}
+
+void nave_liberar(GameState* game, int idx) {
+    game->naves_livres[game->num_naves_livres++] = idx;
+    game->num_naves_ativas--;
+}
+
+void foguete_liberar(GameState* game, int idx) {
+    game->foguetes_livres[game->num_foguetes_livres++] = idx;
+    game->num_foguetes_ativos--;
+}
+
+void nave_desativar(GameState* game, int id) {
+    cols_remove(&game->col_naves, id);
+    grid_remove(&game->grid_naves, id);
+    if (game->sim_mode == SIM_TICK) nave_liberar(game, id);
+}
+
+void foguete_desativar(GameState* game, int id) {
+    cols_remove(&game->col_foguetes, id);
+    grid_remove(&game->grid_foguetes, id);
+    if (game->sim_mode == SIM_TICK) foguete_liberar(game, id);
+}
+
+/* Small live sets: one vector pass over the dense columns is cheaper than
+   walking grid cells. Both paths pick the lowest slot id among the hits. */
+#define COLLIDE_SCAN_MAX 512
+
+static int colidindo(const Grid* g, const EntityCols* c, int x, int y) {
+    int best = -1;
+    if (c->num <= COLLIDE_SCAN_MAX) {
+        for (int base = 0; base < c->num; base += COLLIDE_BATCH) {
+            int n = c->num - base;
+            if (n > COLLIDE_BATCH) n = COLLIDE_BATCH;
+            uint64_t m = collide_box64(c->x + base, c->y + base, n, x, y, HIT_BOX);
+            while (m) {
+                int id = c->id[base + __builtin_ctzll(m)];
+                if (best < 0 || id < best) best = id;
+                m &= m - 1;
+            }
+        }
+        return best;
     }
-    if (idx == -1) {
-        pthread_mutex_unlock(&game->mutex_naves);
-        /* Rollback spawn count since we can't actually spawn */
-        pthread_mutex_lock(&game->mutex_estado);
-        game->naves_spawned--;
-        pthread_mutex_unlock(&game->mutex_estado);
-        return;
+    /* Grid candidates are live by construction (removed on deactivation) */
+    GRID_FOR_EACH(g, x, y, HIT_BOX, i) {
+        int p = c->pos[i];
+        if (abs(c->x[p] - x) <= HIT_BOX && abs(c->y[p] - y) <= HIT_BOX && (best < 0 || i < best))
+            best = i;
     }
+    return best;
+}
+
+int foguete_colidindo(const GameState* game, int x, int y) {
+    return colidindo(&game->grid_foguetes, &game->col_foguetes, x, y);
+}
+
+int nave_colidindo(const GameState* game, int x, int y) {
+    return colidindo(&game->grid_naves, &game->col_naves, x, y);
+}
+
+int64_t game_now_ms(const GameState* game) {
+    if (game->relogio_virtual) return game->relogio_ms;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ---------- Reload heap ---------- */
+
+static inline int64_t heap_key(const GameState* game, int h) {
+    return game->lancadores[game->recarga_heap[h]].pronta_ms;
+}
+
+static void heap_swap(GameState* game, int a, int b) {
+    int la = game->recarga_heap[a], lb = game->recarga_heap[b];
+    game->recarga_heap[a] = lb; game->recarga_pos[lb] = a;
+    game->recarga_heap[b] = la; game->recarga_pos[la] = b;
+}
 
-    game->naves[idx].id = idx;
-    game->naves[idx].x  = (w > 0) ? rand() % w : 0;
-    game->naves[idx].y  = hud;     /* spawn right below HUD */
-    game->naves[idx].ativa = true;
-    game->naves[idx].destruida = false;
-    game->num_naves_ativas++;
-    pthread_mutex_unlock(&game->mutex_naves);
-
-    ThreadArgs* args = (ThreadArgs*)malloc(sizeof(ThreadArgs));
-    if (!args) {
-        /* rollback activation if we can't even allocate args */
-        pthread_mutex_lock(&game->mutex_naves);
-        game->naves[idx].ativa = false;
-        game->num_naves_ativas--;
-        pthread_mutex_unlock(&game->mutex_naves);
-        /* Rollback spawn count */
-        pthread_mutex_lock(&game->mutex_estado);
-        game->naves_spawned--;
-        pthread_mutex_unlock(&game->mutex_estado);
-        return;
+static void heap_up(GameState* game, int h) {
+    while (h > 0) {
+        int parent = (h - 1) / 2;
+        if (heap_key(game, parent) <= heap_key(game, h)) break;
+        heap_swap(game, parent, h);
+        h = parent;
     }
+}
 
-    args->entity = &game->naves[idx];
-    args->game = game;
-    if (pthread_create(&game->naves[idx].thread_id, NULL, thread_nave, args) != 0) {
-        /* rollback activation on create failure */
-        free(args);
-        pthread_mutex_lock(&game->mutex_naves);
-        game->naves[idx].ativa = false;
-        game->num_naves_ativas--;
-        pthread_mutex_unlock(&game->mutex_naves);
-        /* Rollback spawn count */
-        pthread_mutex_lock(&game->mutex_estado);
-        game->naves_spawned--;
-        pthread_mutex_unlock(&game->mutex_estado);
-        return;
+static void heap_down(GameState* game, int h) {
+    for (;;) {
+        int l = 2 * h + 1, r = l + 1, m = h;
+        if (l < game->num_recarga && heap_key(game, l) < heap_key(game, m)) m = l;
+        if (r < game->num_recarga && heap_key(game, r) < heap_key(game, m)) m = r;
+        if (m == h) return;
+        heap_swap(game, h, m);
+        h = m;
     }
+}
 
-    /* Success: spawn count already incremented above */
+void recarga_agendar(GameState* game, int lancador, int64_t pronta_ms) {
+    game->lancadores[lancador].pronta_ms = pronta_ms;
+    int h = game->recarga_pos[lancador];
+    if (h < 0) {
+        h = game->num_recarga++;
+        game->recarga_heap[h] = lancador;
+        game->recarga_pos[lancador] = h;
+    }
+    heap_up(game, h);
+    heap_down(game, game->recarga_pos[lancador]);
 }
 
-bool tentar_disparar(GameState* game) {
-    bool fired = false;
+void recarga_cancelar(GameState* game, int lancador) {
+    int h = game->recarga_pos[lancador];
+    if (h < 0) return;
+    int last = --game->num_recarga;
+    if (h != last) {
+        heap_swap(game, h, last);
+        game->recarga_pos[lancador] = -1;
+        heap_up(game, h);
+        heap_down(game, h);
+    } else {
+        game->recarga_pos[lancador] = -1;
+    }
+}
 
-    pthread_mutex_lock(&game->mutex_lancadores);
+int recarga_vencidas(GameState* game, int64_t now, int64_t* proxima) {
+    int carregados = 0;
+    while (game->num_recarga > 0 && heap_key(game, 0) <= now) {
+        int l = game->recarga_heap[0];
+        recarga_cancelar(game, l);
+        if (!game->lancadores[l].tem_foguete) {
+            game->lancadores[l].tem_foguete = true;
+            atomic_fetch_add_explicit(&game->lancadores_carregados, 1, memory_order_relaxed);
+            carregados++;
+        }
+    }
+    *proxima = (game->num_recarga > 0) ? heap_key(game, 0) : INT64_MAX;
+    return carregados;
+}
+
+uint32_t game_rand(GameState* game) {
+    uint64_t x = game->rng;
+    x ^= x >> 12; x ^= x << 25; x ^= x >> 27;
+    game->rng = x;
+    return (uint32_t)((x * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Randomized spawn interval within [min,max] ms; fixed if equal */
+int game_next_spawn_ms(GameState* game) {
+    const DifficultyConfig* cfg = &game->cfg;
+    if (cfg->spawn_min_ms >= cfg->spawn_max_ms) return cfg->spawn_min_ms;
+    int span = cfg->spawn_max_ms - cfg->spawn_min_ms;
+    return cfg->spawn_min_ms + (int)(game_rand(game) % (uint32_t)(span + 1));
+}
+
+bool game_spawn_tick(GameState* game, int64_t now, int64_t* next_spawn_ms) {
+    Ondas* o = game->ondas;
+    if (o->cur == o->num && !ondas_encher(o, game)) return false;
+    if (now < *next_spawn_ms) return true;
+
+    const int64_t rel = now - game->start_ms;
+    const Metricas m = game_metricas(game);
+    const int32_t vy = FX_POR_MS(game->cfg.ship_speed_ms);   /* down one cell per ship_speed_ms */
+    while (o->bloco[o->cur].t_ms <= rel) {
+        int ids[SPAWN_LOTE], n = 0;
+        LOCK(game, naves);
+        while (n < SPAWN_LOTE && o->cur < o->num && o->bloco[o->cur].t_ms <= rel &&
+               game->num_naves_livres > 0) {
+            const int idx = game->naves_livres[--game->num_naves_livres];
+            const int x = ondas_coluna(&o->bloco[o->cur++], m.w);
+            game->naves[idx].id = idx;
+            game->naves[idx].destruida = false;
+            /* right below the HUD */
+            cols_add(&game->col_naves, idx, x, m.hud, 0, vy, now);
+            grid_insert(&game->grid_naves, idx, x, m.hud);
+            ids[n++] = idx;
+        }
+        game->num_naves_ativas += n;
+        const bool cheio = game->num_naves_livres == 0;
+        UNLOCK(game, naves);
+        atomic_fetch_add_explicit(&game->naves_spawned, n, memory_order_relaxed);
+
+        /* Thread model: the pool owns each ship from here on (one task per
+           live slot, so this cannot overflow); tick mode's loop already does */
+        if (game->sim_mode == SIM_THREADS)
+            for (int i = 0; i < n; i++) pool_submeter(game->pool, nave_passo, game, ids[i], now);
+
+        if (o->cur == o->num && !ondas_encher(o, game)) return false;
+        if (cheio) break;
+    }
+    /* A full pool holds the rest back until a slot can have freed up */
+    *next_spawn_ms = (o->bloco[o->cur].t_ms <= rel) ? now + game->passo_min_ms
+                                                    : game->start_ms + o->bloco[o->cur].t_ms;
+    return true;
+}
+
+bool game_check_end(GameState* game) {
+    atomic_store_explicit(&game->elapsed_sec, (int)((game_now_ms(game) - game->start_ms) / 1000), memory_order_relaxed);
+
+    int total = game->naves_total;
+    int destroyed = atomic_load_explicit(&game->naves_destruidas, memory_order_relaxed);
+    int reached   = atomic_load_explicit(&game->naves_chegaram, memory_order_relaxed);
+
+    bool lose_now = (reached > (total / 2)); /* immediate defeat if > half reached */
+
+    /* Finish only when all ships handled OR defeat now */
+    bool all_handled = (destroyed + reached) >= total;
+
+    if (lose_now || all_handled) {
+        atomic_store(&game->game_over, true);   /* the round; finalizar_threads ends the session */
+        return true;
+    }
+    return false;
+}
+
+bool game_vitoria(const GameState* game) {
+    return game->naves_chegaram <= game->naves_total / 2 && game->naves_destruidas >= game->naves_total / 2;
+}
+
+void game_encerrar(GameState* game) {
+    LOCK(game, estado);   /* cond_game_over's mutex */
+    atomic_store(&game->game_over, true);
+    atomic_store(&game->encerrado, true);
+    pthread_cond_broadcast(&game->cond_game_over);
+    UNLOCK(game, estado);
+}
+
+bool game_esperar_ns(GameState* game, int64_t prazo_ns) {
+    struct timespec ts = { .tv_sec = (time_t)(prazo_ns / 1000000000LL), .tv_nsec = (long)(prazo_ns % 1000000000LL) };
+    LOCK(game, estado);
+    while (!atomic_load(&game->encerrado) &&
+           pthread_cond_timedwait(&game->cond_game_over, &game->mutex_estado, &ts) == 0) { }
+    bool segue = !atomic_load(&game->encerrado);
+    UNLOCK(game, estado);
+    return segue;
+}
+
+void game_reset(GameState* game) {
+    /* No step may run against the slots rebuilt below; the ones already
+       past their game_over check only release their slot */
+    if (game->pool) pool_descartar(game->pool);
+
+    /* lock order: lancadores -> naves -> foguetes -> estado */
+    LOCK(game, lancadores);
+    LOCK(game, naves);
+    LOCK(game, foguetes);
+    game_drenar_eventos(game, NULL);   /* a tick that ended the round may still have pushed some */
+
+    for (int i = 0; i < game->cap_naves; i++) {
+        grid_remove(&game->grid_naves, i);
+        game->col_naves.pos[i] = -1;
+        game->naves_livres[i] = game->cap_naves - 1 - i;
+    }
+    for (int i = 0; i < game->cap_foguetes; i++) {
+        grid_remove(&game->grid_foguetes, i);
+        game->col_foguetes.pos[i] = -1;
+        game->foguetes_livres[i] = game->cap_foguetes - 1 - i;
+    }
+    game->col_naves.num = game->col_foguetes.num = 0;
+    game->num_naves_livres = game->cap_naves;
+    game->num_foguetes_livres = game->cap_foguetes;
+    game->num_naves_ativas = game->num_foguetes_ativos = 0;
+
+    atomic_store(&game->pontuacao, 0);
+    atomic_store(&game->naves_destruidas, 0);
+    atomic_store(&game->naves_chegaram, 0);
+    atomic_store(&game->naves_spawned, 0);
+    atomic_store(&game->shots_fired, 0);
+    atomic_store(&game->shots_hit, 0);
+    atomic_store(&game->current_streak, 0);
+    atomic_store(&game->best_streak, 0);
+    atomic_store(&game->elapsed_sec, 0);
+    if (game->relogio_virtual) game->relogio_ms = 0;
+    game->start_ms = game_now_ms(game);
+    game->sim_t_ms = game->start_ms;
+    ondas_iniciar(game->ondas, game);   /* the rng has moved on: a new layout */
+
+    atomic_store(&game->lancadores_carregados, 0);
+    game->num_recarga = 0;
+    for (int i = 0; i < game->num_lancadores; i++) {
+        game->lancadores[i].tem_foguete = false;
+        game->lancadores[i].direcao = DIR_VERTICAL;
+        game->recarga_pos[i] = -1;
+    }
+    for (int i = 0; i < game->num_lancadores; i++)
+        recarga_agendar(game, i, game->start_ms + game->tempo_recarga);
+
+    LOCK(game, estado);
+    game->bateria_x = game_metricas(game).w / 2;
+    game->direcao_atual = DIR_VERTICAL;
+    atomic_store(&game->game_over, false);
+    UNLOCK(game, estado);
+
+    UNLOCK(game, foguetes);
+    UNLOCK(game, naves);
+    pthread_cond_signal(&game->cond_lancador_vazio);   /* new reload deadlines */
+    UNLOCK(game, lancadores);
+}
+
+void game_evento(GameState* game, int tipo, int x, int y) {
+    Evento ev = { tipo, x, y };
+    /* Sized so this only spins if the consumer stalls for a whole burst.
+       No caller holds an entity lock here (sim_tick pushes its events once
+       it has unlocked), so a spinning producer never blocks the consumer.
+       The headless loop is producer and consumer at once: between two of
+       its drains it pushes one tick's kills and arrivals (<= cap_naves)
+       and the shots fired (<= cap_foguetes), which the ring sized in
+       game_init always holds. */
+    while (!events_push(game->eventos, ev)) sched_yield();
+}
+
+int game_drenar_eventos(GameState* game, void (*explosao)(int x, int y)) {
+    int abates = 0, chegadas = 0, disparos = 0, n = 0;
+    int streak = atomic_load_explicit(&game->current_streak, memory_order_relaxed);
+    int best = 0;
+    Evento ev;
+    while (events_pop(game->eventos, &ev)) {
+        n++;
+        switch (ev.tipo) {
+            case EV_ABATE:
+                abates++;
+                if (++streak > best) best = streak;
+                if (explosao) explosao(ev.x, ev.y);
+                break;
+            case EV_CHEGADA:
+                chegadas++;
+                streak = 0; /* break combo */
+                break;
+            case EV_DISPARO:
+                disparos++;
+                break;
+        }
+    }
+    if (n == 0) return 0;
+
+    /* Only writer of these, so plain adds/stores of the batch suffice */
+    atomic_fetch_add_explicit(&game->naves_destruidas, abates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&game->naves_chegaram, chegadas, memory_order_relaxed);
+    atomic_fetch_add_explicit(&game->pontuacao, 10 * abates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&game->shots_hit, abates, memory_order_relaxed);
+    atomic_fetch_add_explicit(&game->shots_fired, disparos, memory_order_relaxed);
+    atomic_store_explicit(&game->current_streak, streak, memory_order_relaxed);
+    if (best > atomic_load_explicit(&game->best_streak, memory_order_relaxed))
+        atomic_store_explicit(&game->best_streak, best, memory_order_relaxed);
+    return n;
+}
+
+bool tentar_disparar(GameState* game) {
+    LOCK(game, lancadores);
     int lancador_idx = -1;
     for (int i = 0; i < game->num_lancadores; i++) {
         if (game->lancadores[i].tem_foguete) { lancador_idx = i; break; }
     }
-    if (lancador_idx == -1) {
-        pthread_mutex_unlock(&game->mutex_lancadores);
+    if (lancador_idx == -1 || atomic_load(&game->game_over)) {   /* none loaded, or between rounds */
+        UNLOCK(game, lancadores);
         return false;
     }
 
-    pthread_mutex_lock(&game->mutex_foguetes);
-    int foguete_idx = -1;
-    for (int i = 0; i < MAX_FOGUETES; i++) {
-        if (!game->foguetes[i].ativa) { foguete_idx = i; break; }
-    }
-    if (foguete_idx == -1) {
-        pthread_mutex_unlock(&game->mutex_foguetes);
-        pthread_mutex_unlock(&game->mutex_lancadores);
+    LOCK(game, foguetes);
+    if (game->num_foguetes_livres == 0) {
+        UNLOCK(game, foguetes);
+        UNLOCK(game, lancadores);
         return false;
     }
+    int foguete_idx = game->foguetes_livres[--game->num_foguetes_livres];
 
     int bx, sw, sh, ch;
     DirecaoDisparo dir;
-    pthread_mutex_lock(&game->mutex_estado);
+    LOCK(game, estado);
     bx  = game->bateria_x;
     dir = game->direcao_atual;
-    sw  = game->screen_width;
-    sh  = game->screen_height;
-    ch  = game->controls_height;
-    pthread_mutex_unlock(&game->mutex_estado);
-
+    UNLOCK(game, estado);
+    Metricas m = game_metricas(game);
+    sw  = m.w;
+    sh  = m.h;
+    ch  = m.ch;
+
+    int fx = (bx < 0) ? 0 : ((bx >= sw) ? sw-1 : bx);
+    int fy = (sh - ch - 1); /* ground line */
+    int dx = 0, dy = -1;
+    switch (dir) {
+        case DIR_VERTICAL:        dx = 0;  dy = -1; break;
+        case DIR_DIAGONAL_ESQ:    dx = -1; dy = -1; break;
+        case DIR_DIAGONAL_DIR:    dx = 1;  dy = -1; break;
+        case DIR_HORIZONTAL_ESQ:  dx = -1; dy = 0;  break;
+        case DIR_HORIZONTAL_DIR:  dx = 1;  dy = 0;  break;
+    }
     game->foguetes[foguete_idx].id = foguete_idx;
-    game->foguetes[foguete_idx].x  = (bx < 0) ? 0 : ((bx >= sw) ? sw-1 : bx);
-    game->foguetes[foguete_idx].y  = (sh - ch - 1); /* ground line */
     game->foguetes[foguete_idx].direcao = dir;
     game->foguetes[foguete_idx].lancador_id = lancador_idx;
-    game->foguetes[foguete_idx].ativa = true;
+    const int32_t v = FX_POR_MS(ROCKET_STEP_MS);
+    cols_add(&game->col_foguetes, foguete_idx, fx, fy, dx * v, dy * v, game_now_ms(game));
+    grid_insert(&game->grid_foguetes, foguete_idx, fx, fy);
     game->num_foguetes_ativos++;
 
     game->lancadores[lancador_idx].tem_foguete = false;
+    game->lancadores[lancador_idx].direcao = dir;
+    atomic_fetch_sub_explicit(&game->lancadores_carregados, 1, memory_order_relaxed);
+    recarga_agendar(game, lancador_idx, game_now_ms(game) + game->tempo_recarga);
     pthread_cond_signal(&game->cond_lancador_vazio);
 
-    pthread_mutex_unlock(&game->mutex_foguetes);
-    pthread_mutex_unlock(&game->mutex_lancadores);
-
-    ThreadArgs* args = (ThreadArgs*)malloc(sizeof(ThreadArgs));
-    if (!args) {
-        /* rollback launcher slot since we couldn’t launch */
-        pthread_mutex_lock(&game->mutex_foguetes);
-        game->foguetes[foguete_idx].ativa = false;
-        game->num_foguetes_ativos--;
-        pthread_mutex_unlock(&game->mutex_foguetes);
-
-        pthread_mutex_lock(&game->mutex_lancadores);
-        game->lancadores[lancador_idx].tem_foguete = true;
-        pthread_mutex_unlock(&game->mutex_lancadores);
-        return false;
-    }
+    UNLOCK(game, foguetes);
+    UNLOCK(game, lancadores);
 
-    args->entity = &game->foguetes[foguete_idx];
-    args->game = game;
-    if (pthread_create(&game->foguetes[foguete_idx].thread_id, NULL, thread_foguete, args) != 0) {
-        /* rollback on create failure */
-        free(args);
-        pthread_mutex_lock(&game->mutex_foguetes);
-        game->foguetes[foguete_idx].ativa = false;
-        game->num_foguetes_ativos--;
-        pthread_mutex_unlock(&game->mutex_foguetes);
-
-        pthread_mutex_lock(&game->mutex_lancadores);
-        game->lancadores[lancador_idx].tem_foguete = true;
-        pthread_mutex_unlock(&game->mutex_lancadores);
-        return false;
-    }
+    /* Thread model: the pool owns the rocket from here on (one task per
+       live slot, so this cannot overflow) */
+    if (game->sim_mode == SIM_THREADS)
+        pool_submeter(game->pool, foguete_passo, game, foguete_idx, game_now_ms(game));
 
-    /* Success: NOW count the shot */
-    pthread_mutex_lock(&game->mutex_estado);
-    game->shots_fired++;
-    pthread_mutex_unlock(&game->mutex_estado);
+    game_evento(game, EV_DISPARO, fx, fy);
+    return true;
+}
 
-    fired = true;
-    return fired;
+void game_wake_input(GameState* game) {
+    char b = 1;
+    ssize_t r = write(game->wake_fd[1], &b, 1);   /* full pipe is fine: already woken */
+    (void)r;
 }
 
-void finalizar_threads(GameState* game) {
-    /* Signal shutdown to all workers */
-    pthread_mutex_lock(&game->mutex_estado);
-    atomic_store(&game->game_over, true);
-    pthread_cond_broadcast(&game->cond_game_over);
-    pthread_mutex_unlock(&game->mutex_estado);
+void avisar_threads(GameState* game) {
+    /* Signal shutdown to all workers (and the frame/tick sleepers) */
+    game_encerrar(game);
 
     /* Wake reloader if waiting */
-    pthread_mutex_lock(&game->mutex_lancadores);
+    LOCK(game, lancadores);
     pthread_cond_broadcast(&game->cond_lancador_vazio);
-    pthread_mutex_unlock(&game->mutex_lancadores);
-
-    /* Snapshot ALL thread IDs that were ever created (join by id, not by 'ativa') */
-    pthread_t nave_tids[MAX_NAVES];    int nave_count = 0;
-    pthread_mutex_lock(&game->mutex_naves);
-    for (int i = 0; i < MAX_NAVES; i++) {
-        if (game->naves[i].thread_id) {
-            nave_tids[nave_count++] = game->naves[i].thread_id;
-            game->naves[i].thread_id = 0; /* prevent accidental double join */
-        }
-    }
-    pthread_mutex_unlock(&game->mutex_naves);
-
-    pthread_t foguete_tids[MAX_FOGUETES]; int foguete_count = 0;
-    pthread_mutex_lock(&game->mutex_foguetes);
-    for (int i = 0; i < MAX_FOGUETES; i++) {
-        if (game->foguetes[i].thread_id) {
-            foguete_tids[foguete_count++] = game->foguetes[i].thread_id;
-            game->foguetes[i].thread_id = 0;
-        }
-    }
-    pthread_mutex_unlock(&game->mutex_foguetes);
+    UNLOCK(game, lancadores);
+
+    /* Wake the input thread out of poll() */
+    game_wake_input(game);
+}
+
+void finalizar_threads(GameState* game) {
+    avisar_threads(game);
 
-    /* Join outside locks */
-    for (int i = 0; i < nave_count; i++)    pthread_join(nave_tids[i], NULL);
-    for (int i = 0; i < foguete_count; i++) pthread_join(foguete_tids[i], NULL);
+    /* Entity steps: wake and join the pool workers in one go */
+    if (game->pool) pool_parar(game->pool);
 
     pthread_join(game->thread_input, NULL);
     pthread_join(game->thread_artilheiro, NULL);
+    if (game->sim_mode == SIM_TICK) pthread_join(game->thread_simulacao, NULL);
 }
@@ -10,11 +10,23 @@
  #include <stdint.h>
  #include <stdatomic.h>
  #include <time.h>
+ #include "grid.h"
  
- /* Upper bounds (storage only; rendering adapts to terminal size) */
- #define MAX_NAVES        80
- #define MAX_FOGUETES     150
- #define MAX_LANCADORES   15
+ /* Default pool capacities (storage only; overridable per run via GameOptions) */
+ #define DEF_MAX_NAVES    80
+ #define DEF_MAX_FOGUETES 150
+ #define POOL_LIMIT       (1 << 20)
+ #define SPAWN_LOTE       256       /* ships admitted per mutex_naves hold */
+ 
+ /* Simulation model (A/B switch, see GameOptions) */
+ typedef enum {
+     SIM_THREADS = 0,   /* one pthread per ship/rocket (classic) */
+     SIM_TICK    = 1    /* single fixed-step tick loop advances everything */
+ } SimMode;
+ 
+ #define DEF_TICK_MS      5
+ #define ROCKET_STEP_MS   35
+ #define DEF_FPS          30
  
  /* Directions */
  typedef enum {
@@ -28,26 +40,70 @@
  typedef struct {
      bool tem_foguete;
      DirecaoDisparo direcao;
+     int64_t pronta_ms;    /* reload deadline while empty (game_now_ms) */
  } Lancador;
  
+ /* Cold per-slot data; positions live in EntityCols below */
  typedef struct {
      int id;
-     int x, y;
-     bool ativa;
      bool destruida;
-     pthread_t thread_id;
  } Nave;
  
  typedef struct {
      int id;
-     int x, y;
-     int dx, dy;
      DirecaoDisparo direcao;
      int lancador_id;
-     bool ativa;
-     pthread_t thread_id;
  } Foguete;
  
+ /* Fixed-point motion: positions are 16.16 cells, velocities 16.16 cells
+    per second. An entity keeps its origin (position at t0) and velocity,
+    so its position at any time is exact, with no per-step accumulation. */
+ #define FX_SHIFT 16
+ #define FX_ONE   (1 << FX_SHIFT)
+ #define FX_CENTRO(c)    (((int32_t)(c) << FX_SHIFT) + FX_ONE / 2)
+ #define FX_POR_MS(ms)   ((int32_t)((int64_t)FX_ONE * 1000 / (ms)))   /* one cell every `ms` */
+ 
+ /* Cell reached `dt_ms` after being at `o` with velocity `v` (floor) */
+ static inline int fx_celula(int32_t o, int32_t v, int64_t dt_ms) {
+     return (int)(((int64_t)o + (int64_t)v * dt_ms / 1000) >> FX_SHIFT);
+ }
+ 
+ /* Hot per-entity columns (structure of arrays), packed over live entities.
+  * Columns are valid in [0, num); a death swap-removes the last live entry
+  * into the hole, so every loop over live entities is a dense walk. `pos`
+  * maps a stable slot id to its current dense index, -1 when not live: that
+  * flip is the "ativa" transition gate. x/y hold the current cell, which is
+  * all the grid and the collision test ever see. Ships move along +y. */
+ typedef struct {
+     int      num;
+     int*     id;             /* dense -> slot id */
+     int*     pos;            /* slot id -> dense, -1 if not live */
+     int*     x;              /* current cell */
+     int*     y;
+     int32_t* ox;             /* 16.16 position at t0_ms */
+     int32_t* oy;
+     int32_t* vx;             /* 16.16 cells per second */
+     int32_t* vy;
+     int64_t* t0_ms;
+ } EntityCols;
+ 
+ static inline bool col_viva(const EntityCols* c, int id) { return c->pos[id] >= 0; }
+ 
+ /* Moves dense entry p to its cell at time t; true if the cell changed */
+ static inline bool col_avancar(EntityCols* c, int p, int64_t t) {
+     int64_t dt = t - c->t0_ms[p];
+     if (dt <= 0) return false;
+     int x = fx_celula(c->ox[p], c->vx[p], dt);
+     int y = fx_celula(c->oy[p], c->vy[p], dt);
+     if (x == c->x[p] && y == c->y[p]) return false;
+     c->x[p] = x;
+     c->y[p] = y;
+     return true;
+ }
+ 
+ /* Time dense entry p enters its next cell (INT64_MAX if it is at rest) */
+ int64_t col_proxima_ms(const EntityCols* c, int p);
+ 
  typedef struct {
      int id;               /* 0=Easy,1=Medium,2=Hard */
      const char* name;     /* "Easy"/"Medium"/"Hard" */
@@ -57,47 +113,134 @@
      int ship_speed_ms;    /* vertical step time for ships */
      int spawn_min_ms;     /* spawn interval minimum (ms) */
      int spawn_max_ms;     /* spawn interval maximum (ms); if equal to min => fixed */
+     int max_naves;        /* ship pool capacity, 0 = default */
+     int max_foguetes;     /* rocket pool capacity, 0 = default */
+     int formacao_max;     /* largest formation or burst, <= 1 = ships come one at a time (waves.h) */
+     int enxame;           /* ships in each swarm wave, 0 = no swarms */
  } DifficultyConfig;
  
+ /* Built-in presets (0=Easy, 1=Medium, 2=Hard); config.h adds more from a file */
+ #define NUM_DIFFS 3
+ extern const DifficultyConfig DIFFS[NUM_DIFFS];
+ 
+ /* Startup options (parsed by main, consumed by game_init) */
+ typedef struct {
+     int dificuldade;
+     const DifficultyConfig* perfil; /* --config profile; NULL = DIFFS[dificuldade] */
+     SimMode sim_mode;
+     int tick_ms;          /* SIM_TICK step period */
+     int max_naves;        /* ship pool capacity (0 = default) */
+     int max_foguetes;     /* rocket pool capacity (0 = default) */
+     int fps;              /* render target frame rate, 0 = uncapped */
+     bool headless;        /* no ncurses, virtual clock, implies SIM_TICK */
+     uint64_t seed;        /* PRNG seed (0 = from the wall clock) */
+     int ships;            /* total ships override (0 = preset) */
+     int spawn_ms;         /* fixed spawn interval override (0 = preset) */
+     bool varrido;         /* --swept: whole ticks with swept collision (SIM_TICK) */
+ } GameOptions;
+ 
+ /* Screen metrics, published as one packed atomic word (see game_metricas) */
  typedef struct {
-     /* ========= Dynamic screen metrics (updated by renderer) ========= */
-     int screen_width;           // guarded by mutex_estado
-     int screen_height;          // guarded by mutex_estado
-     int hud_height;             // guarded by mutex_estado (constant 3)
-     int controls_height;        // guarded by mutex_estado (constant 2)
- 
-     /* ========= Game state (mutex_estado) ========= */
-     int pontuacao;
+     int w, h;
+     int hud;              /* HUD rows at the top (constant 3) */
+     int ch;               /* controls rows at the bottom (constant 2) */
+ } Metricas;
+
+ typedef struct {
+     /* ========= Dynamic screen metrics (updated by game_resize) =========
+      * w | h << 16 | hud << 32 | ch << 48: readers get a consistent set
+      * with one load and never take a lock. */
+     _Atomic uint64_t metricas;
+
+     /* ========= Counters =========
+      * Atomic so readers never lock. Kills, arrivals, shots and streaks
+      * are written only by game_drenar_eventos (one consumer); readers
+      * only need eventually consistent values. */
+     atomic_int pontuacao;
      int naves_total;            /* target total for the level */
-     int naves_destruidas;
-     int naves_chegaram;
-     int naves_spawned;          /* how many have been spawned so far */
-     atomic_bool game_over;
+     atomic_int naves_destruidas;
+     atomic_int naves_chegaram;
+     atomic_int naves_spawned;   /* how many have been spawned so far (spawner only writes) */
+     atomic_bool game_over;      /* this round is over */
+     atomic_bool encerrado;      /* the session is over: input, reloader and tick threads exit */
      int dificuldade;
      DifficultyConfig cfg;
-     time_t start_time;
-     int elapsed_sec;
+     SimMode sim_mode;           /* immutable after game_init */
+     int tick_ms;
+     int fps;                    /* render target, 0 = uncapped (immutable) */
+     int frames_rendered;        /* owned by thread_principal */
+     int frames_skipped;
+     int64_t start_ms;           /* game_now_ms at game_init */
+     int64_t sim_t_ms;           /* SIM_TICK: time every entity has been advanced to */
+     int passo_min_ms;           /* fastest entity's ms per cell (tick sub-step) */
+     bool varrido;               /* SIM_TICK --swept: whole ticks, swept collision (immutable) */
+     atomic_int elapsed_sec;
+
+     /* ========= Time & randomness =========
+      * The virtual clock (headless) only advances when the owner of the
+      * loop says so; rng and the spawn timeline are used by the spawner
+      * only (thread_principal or the headless loop), so neither needs a
+      * lock. */
+     bool relogio_virtual;
+     int64_t relogio_ms;
+     uint64_t rng;
+     uint64_t semente;           /* rng as seeded, before the first timeline drew from it */
+     struct Ondas* ondas;        /* this level's spawn timeline (see waves.h) */
  
-     /* Player performance stats (mutex_estado) */
-     int shots_fired;
-     int shots_hit;
-     int current_streak;
-     int best_streak;
+     /* Player performance stats (atomic, as above) */
+     atomic_int shots_fired;
+     atomic_int shots_hit;
+     atomic_int current_streak;
+     atomic_int best_streak;
  
      /* ========= Battery (mutex_estado) ========= */
      int bateria_x;
      DirecaoDisparo direcao_atual;
  
      /* ========= Launchers (mutex_lancadores) ========= */
-     Lancador lancadores[MAX_LANCADORES];
+     Lancador* lancadores;           // [num_lancadores], carved from arena
      int num_lancadores;
+     atomic_int lancadores_carregados; // written under mutex_lancadores, read lock-free
      int tempo_recarga; // ms
+     int* recarga_heap;              // empty launchers, min-heap on pronta_ms (mutex_lancadores)
+     int* recarga_pos;               // launcher -> heap index, -1 if loaded
+     int num_recarga;
  
-     /* ========= Entities ========= */
-     Nave naves[MAX_NAVES];          // (mutex_naves)
-     int num_naves_ativas;
-     Foguete foguetes[MAX_FOGUETES]; // (mutex_foguetes)
-     int num_foguetes_ativos;
+     /* ========= Entities =========
+      * Fixed-capacity pools carved from one arena allocation. Each pool has
+      * a free-slot stack so spawn/fire are O(1); a slot is returned to it
+      * only once nothing references it any more (the entity's last pool
+      * step in SIM_THREADS, deactivation in SIM_TICK). */
+     void* arena;
+     EntityCols col_naves;           // live ship columns (mutex_naves)
+     EntityCols col_foguetes;        // live rocket columns (mutex_foguetes)
+     Nave* naves;                    // [cap_naves] (mutex_naves)
+     int cap_naves;
+     int* naves_livres;              // free-slot stack (mutex_naves)
+     int num_naves_livres;
+     int num_naves_ativas;           // == cap_naves - num_naves_livres
+     Foguete* foguetes;              // [cap_foguetes] (mutex_foguetes)
+     int cap_foguetes;
+     int* foguetes_livres;           // free-slot stack (mutex_foguetes)
+     int num_foguetes_livres;
+     int num_foguetes_ativos;        // == cap_foguetes - num_foguetes_livres
+ 
+     /* ========= Collision broad-phase (same mutex as the entities) ========= */
+     Grid grid_naves;                // active ships by cell (mutex_naves)
+     Grid grid_foguetes;             // active rockets by cell (mutex_foguetes)
+     int64_t* varre_fim;             // --swept: [cap_naves] landing ms this tick (sim_tick only)
+     struct Impacto* varre_imp;      // --swept: this tick's hits and landings, sized at game_init
+     int varre_cap;
+     struct Evento* tick_ev;         // SIM_TICK: [cap_naves] this tick's kills/arrivals, pushed after unlock
+     int num_tick_ev;
+ 
+     /* ========= Published frames (see snapshot.h) ========= */
+     struct SnapChannel* snap_render; // simulation -> renderer
+     struct EventRing* eventos;       // simulation -> main loop (MPSC)
+     struct ReplayWriter* gravador;   // --record (see replay.h), NULL when off
+     struct SpectServer* espect;      // --serve (see spectate.h), NULL when off
+     struct Autopilot* piloto;        // --autopilot (see autopilot.h), NULL when off
+     _Atomic uint32_t resize_pedido;  // renderer -> simulation: (w << 16) | h, 0 = none
  
      /* ========= Sync primitives ========= */
      pthread_mutex_t mutex_naves;
@@ -108,19 +251,107 @@
  
      pthread_cond_t cond_lancador_vazio;
      pthread_cond_t cond_game_over;
+     int wake_fd[2];             // input wakeup pipe: thread_input polls [0]
  
      /* ========= Thread handles ========= */
      pthread_t thread_input;
      pthread_t thread_artilheiro;
+     pthread_t thread_simulacao; /* SIM_TICK only */
+     struct WorkerPool* pool;    /* SIM_THREADS entity steps (see pool.h) */
  } GameState;
  
  /* ========= API ========= */
- void game_init(GameState* game, int dificuldade);
+ int  game_init(GameState* game, const GameOptions* opts); /* 0 on success */
  void game_cleanup(GameState* game);
  
- void criar_nave(GameState* game);
+ /* Spawn and fire never allocate: slots come from the pool free stacks and
+    the pool task is just (step function, game, slot id) */
  bool tentar_disparar(GameState* game); /* returns true if a rocket was actually fired */
  void finalizar_threads(GameState* game);
+ /* The signalling half of finalizar_threads: raises encerrado and wakes
+    every sleeper, joins nothing. For unwinding a partial start. */
+ void avisar_threads(GameState* game);
+
+ /* Updates elapsed time and, once all ships are handled or too many reached
+    the ground, raises game_over. Returns true when the game is over. */
+ bool game_check_end(GameState* game);
+
+ /* Victory: at most half reached the ground and at least half destroyed */
+ bool game_vitoria(const GameState* game);
+
+ /* Ends the session: raises game_over and encerrado and wakes everyone in
+    game_esperar_ns */
+ void game_encerrar(GameState* game);
+
+ /* Sleeps until the absolute CLOCK_MONOTONIC time prazo_ns, or less if the
+    session ends first (timed wait on cond_game_over). False once it has. */
+ bool game_esperar_ns(GameState* game, int64_t prazo_ns);
+
+ /* --rounds: puts a finished round back to its starting state in place.
+    Nothing is allocated or freed and every thread stays up; queued pool
+    steps are dropped first. Called by the thread that ran the round. */
+ void game_reset(GameState* game);
+
+ /* Once *next_spawn_ms has passed, admits every timeline entry due by now
+    in batches of SPAWN_LOTE per mutex_naves hold and stores when the next
+    one is due (or, with the ship pool full, when to retry). Returns false
+    once every ship of the level has been spawned. */
+ bool game_spawn_tick(GameState* game, int64_t now, int64_t* next_spawn_ms);
+
+ /* Reload schedule (caller holds mutex_lancadores): every empty launcher
+    sits in a min-heap keyed by its ready time, so all of them reload in
+    parallel. recarga_agendar starts a reload; recarga_vencidas loads every
+    launcher whose deadline has passed and returns how many, storing the
+    next deadline (INT64_MAX if none) in *proxima. */
+ void recarga_agendar(GameState* game, int lancador, int64_t pronta_ms);
+ void recarga_cancelar(GameState* game, int lancador);
+ int  recarga_vencidas(GameState* game, int64_t now, int64_t* proxima);
+
+ /* Seeded xorshift64* PRNG (spawner only, see GameState.rng) */
+ uint32_t game_rand(GameState* game);
+ int game_next_spawn_ms(GameState* game);
+ void game_wake_input(GameState* game);    /* unblock thread_input's poll() */
+ 
+ static inline Metricas game_metricas(const GameState* game) {
+     uint64_t m = atomic_load_explicit(&game->metricas, memory_order_acquire);
+     Metricas r = { (int)(m & 0xFFFF), (int)((m >> 16) & 0xFFFF),
+                    (int)((m >> 32) & 0xFFFF), (int)(m >> 48) };
+     return r;
+ }
+
+ /* Gameplay events (see events.h). game_evento may be called from any
+    thread (tipo is an EventoTipo); game_drenar_eventos is the single
+    consumer: it applies every queued kill/arrival/shot to the counters in
+    one batch and passes kill positions to `explosao` (may be NULL).
+    Returns the number of events drained. */
+ void game_evento(GameState* game, int tipo, int x, int y);
+ int  game_drenar_eventos(GameState* game, void (*explosao)(int x, int y));
+
+ /* Publish new terminal metrics and re-bucket the collision grids */
+ void game_resize(GameState* game, int w, int h);
+ 
+ /* Lock-free resize hand-off: the renderer posts the terminal size, the
+    simulation side applies it before its next publish */
+ void game_request_resize(GameState* game, int w, int h);
+ void game_apply_resize(GameState* game);
+ 
+ /* Entity exit: swap-removes it from the live columns and its grid; in
+    SIM_TICK the slot is also released. Caller holds the entity mutex. */
+ void nave_desativar(GameState* game, int id);
+ void foguete_desativar(GameState* game, int id);
+ 
+ /* Return a slot to its pool's free stack (caller holds the entity mutex) */
+ void nave_liberar(GameState* game, int idx);
+ void foguete_liberar(GameState* game, int idx);
+ 
+ /* Lowest slot id of a live entity inside the forgiving hit box (|dx|<=2, |dy|<=2)
+    around (x, y), or -1. Caller holds mutex_foguetes / mutex_naves respectively. */
+ #define HIT_BOX 2
+ int foguete_colidindo(const GameState* game, int x, int y);
+ int nave_colidindo(const GameState* game, int x, int y);
+ 
+ /* Monotonic clock in milliseconds; the virtual clock when headless */
+ int64_t game_now_ms(const GameState* game);
  
  #endif /* GAME_H */
  
\ No newline at end of file
@@ -0,0 +1,67 @@
+/**
+ * grid.c - Uniform cell grid (see grid.h)
+ */
+#include "grid.h"
+#include <stdlib.h>
+
+static void grid_clear(Grid* g) {
+    for (int i = 0; i < g->cols * g->rows; i++) g->head[i] = -1;
+    for (int i = 0; i < g->cap; i++) g->cell[i] = -1;
+}
+
+int grid_init(Grid* g, int cap, int w, int h) {
+    g->cols = g->rows = 0;
+    g->cap  = cap;
+    g->head = NULL;
+    g->next = (int*)malloc(sizeof(int) * (size_t)cap * 3);
+    if (!g->next) return -1;
+    g->prev = g->next + cap;
+    g->cell = g->prev + cap;
+    return grid_resize(g, w, h);
+}
+
+void grid_free(Grid* g) {
+    free(g->head);
+    free(g->next);
+    g->head = g->next = g->prev = g->cell = NULL;
+    g->cols = g->rows = g->cap = 0;
+}
+
+int grid_resize(Grid* g, int w, int h) {
+    int cols = (w > 0) ? (w + GRID_CELL - 1) / GRID_CELL : 1;
+    int rows = (h > 0) ? (h + GRID_CELL - 1) / GRID_CELL : 1;
+    if (!g->head || cols * rows > g->cols * g->rows) {
+        int* head = (int*)realloc(g->head, sizeof(int) * (size_t)(cols * rows));
+        if (!head) return -1;
+        g->head = head;
+    }
+    g->cols = cols;
+    g->rows = rows;
+    grid_clear(g);
+    return 0;
+}
+
+void grid_insert(Grid* g, int id, int x, int y) {
+    int c = grid_cy(g, y) * g->cols + grid_cx(g, x);
+    g->cell[id] = c;
+    g->prev[id] = -1;
+    g->next[id] = g->head[c];
+    if (g->head[c] >= 0) g->prev[g->head[c]] = id;
+    g->head[c] = id;
+}
+
+void grid_remove(Grid* g, int id) {
+    int c = g->cell[id];
+    if (c < 0) return;
+    if (g->prev[id] >= 0) g->next[g->prev[id]] = g->next[id];
+    else                  g->head[c] = g->next[id];
+    if (g->next[id] >= 0) g->prev[g->next[id]] = g->prev[id];
+    g->cell[id] = -1;
+}
+
+void grid_move(Grid* g, int id, int x, int y) {
+    int c = grid_cy(g, y) * g->cols + grid_cx(g, x);
+    if (c == g->cell[id]) return;
+    grid_remove(g, id);
+    grid_insert(g, id, x, y);
+}
@@ -0,0 +1,56 @@
+#ifndef GRID_H
+#define GRID_H
+
+/**
+ * grid.h - Uniform cell grid for collision broad-phase
+ *
+ * Entities are bucketed by (x, y) into GRID_CELL x GRID_CELL cells, each
+ * cell holding an intrusive doubly-linked list of entity ids, so insert,
+ * remove and move are O(1). Coordinates outside the grid clamp to the edge
+ * cells, which keeps queries correct when the terminal shrinks between
+ * rebuilds. No internal locking: each grid is guarded by its entity mutex.
+ */
+
+#define GRID_CELL 4
+
+typedef struct {
+    int cols, rows;
+    int cap;          /* max entity id + 1 */
+    int* head;        /* [cols*rows] first id in cell, -1 if empty */
+    int* next;        /* [cap] */
+    int* prev;        /* [cap] */
+    int* cell;        /* [cap] current cell of id, -1 if not in grid */
+} Grid;
+
+int  grid_init(Grid* g, int cap, int w, int h);   /* 0 on success */
+void grid_free(Grid* g);
+int  grid_resize(Grid* g, int w, int h);          /* empties the grid */
+
+void grid_insert(Grid* g, int id, int x, int y);
+void grid_remove(Grid* g, int id);
+void grid_move(Grid* g, int id, int x, int y);
+
+static inline int grid_cx(const Grid* g, int x) {
+    int c = x / GRID_CELL;
+    return (x < 0) ? 0 : (c >= g->cols ? g->cols - 1 : c);
+}
+static inline int grid_cy(const Grid* g, int y) {
+    int c = y / GRID_CELL;
+    return (y < 0) ? 0 : (c >= g->rows ? g->rows - 1 : c);
+}
+
+/* Iterate ids in the cells overlapping [x-r, x+r] x [y-r, y+r]:
+ *     GRID_FOR_EACH(g, x, y, r, id) { ... }
+ * Use `goto` or a flag to leave early; `break` only exits one cell. */
+#define GRID_FOR_EACH(g, x, y, r, id)                                          \
+    for (int gcy_ = grid_cy((g), (y) - (r)); gcy_ <= grid_cy((g), (y) + (r)); gcy_++) \
+    for (int gcx_ = grid_cx((g), (x) - (r)); gcx_ <= grid_cx((g), (x) + (r)); gcx_++) \
+    for (int id = (g)->head[gcy_ * (g)->cols + gcx_]; id >= 0; id = (g)->next[id])
+
+/* Same over the cells overlapping [x0, x1] x [y0, y1] */
+#define GRID_FOR_EACH_RECT(g, x0, y0, x1, y1, id)                              \
+    for (int gcy_ = grid_cy((g), (y0)); gcy_ <= grid_cy((g), (y1)); gcy_++) \
+    for (int gcx_ = grid_cx((g), (x0)); gcx_ <= grid_cx((g), (x1)); gcx_++) \
+    for (int id = (g)->head[gcy_ * (g)->cols + gcx_]; id >= 0; id = (g)->next[id])
+
+#endif /* GRID_H */
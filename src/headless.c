@@ -0,0 +1,214 @@
+/**
+ * headless.c - Deterministic simulation without a terminal (see headless.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "headless.h"
+#include "threads.h"
+#include "input.h"
+#include "replay.h"
+#include "autopilot.h"
+#include <ncurses.h>   /* KEY_* codes only; ncurses is never initialised here */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/resource.h>
+
+typedef struct {
+    int64_t t;            /* next firing time */
+    int key;
+    int restantes;        /* firings left */
+    int periodo;
+    int64_t t0;           /* as loaded, for script_rewind */
+    int total;
+} ScriptEv;
+
+typedef struct {
+    ScriptEv* ev;
+    int num, cap;
+} Script;
+
+static int parse_key(const char* s) {
+    if (strcmp(s, "space") == 0) return ' ';
+    if (strcmp(s, "left")  == 0) return KEY_LEFT;
+    if (strcmp(s, "right") == 0) return KEY_RIGHT;
+    if (strcmp(s, "up")    == 0) return KEY_UP;
+    if (strcmp(s, "esc")   == 0) return 27;
+    if (s[0] && !s[1]) return (unsigned char)s[0];
+    return -1;
+}
+
+static int script_load(Script* sc, const char* path) {
+    memset(sc, 0, sizeof(*sc));
+    if (!path) return 0;
+    FILE* f = fopen(path, "r");
+    if (!f) { fprintf(stderr, "Cannot open script %s\n", path); return -1; }
+
+    char line[128];
+    int lineno = 0;
+    while (fgets(line, sizeof line, f)) {
+        lineno++;
+        char* p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\0') continue;
+
+        long long t; char name[16]; int count = 1, every = 0;
+        int n = sscanf(p, "%lld %15s %d %d", &t, name, &count, &every);
+        int key = (n >= 2) ? parse_key(name) : -1;
+        if (key < 0 || t < 0 || n == 3 || count < 1 || (count > 1 && every <= 0)) {
+            fprintf(stderr, "%s:%d: bad script line\n", path, lineno);
+            fclose(f); free(sc->ev); return -1;
+        }
+        if (sc->num == sc->cap) {
+            int cap = sc->cap ? sc->cap * 2 : 16;
+            ScriptEv* ev = (ScriptEv*)realloc(sc->ev, sizeof(ScriptEv) * (size_t)cap);
+            if (!ev) { fclose(f); free(sc->ev); return -1; }
+            sc->ev = ev; sc->cap = cap;
+        }
+        sc->ev[sc->num++] = (ScriptEv){ (int64_t)t, key, count, every, (int64_t)t, count };
+    }
+    fclose(f);
+    return 0;
+}
+
+/* Feeds every event due by `now`, earliest first (file order on ties) */
+static void script_feed(Script* sc, GameState* game, int64_t now) {
+    for (;;) {
+        int best = -1;
+        for (int i = 0; i < sc->num; i++) {
+            ScriptEv* e = &sc->ev[i];
+            if (e->restantes > 0 && e->t <= now && (best < 0 || e->t < sc->ev[best].t)) best = i;
+        }
+        if (best < 0) return;
+        ScriptEv* e = &sc->ev[best];
+        process_input(game, e->key);
+        e->restantes--;
+        e->t += e->periodo;
+    }
+}
+
+static void script_rewind(Script* sc) {
+    for (int i = 0; i < sc->num; i++) {
+        sc->ev[i].t = sc->ev[i].t0;
+        sc->ev[i].restantes = sc->ev[i].total;
+    }
+}
+
+static inline int64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int cmp_u32(const void* a, const void* b) {
+    uint32_t x = *(const uint32_t*)a, y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+typedef struct {
+    uint32_t* v;          /* per-tick latency, ns */
+    long cap;
+} Latencias;
+
+/* One round, until game_over */
+static void jogar_ronda(GameState* game, Script* sc, ReplayReader* replay, HeadlessReport* rep, Latencias* lat) {
+    int64_t next_spawn = game->start_ms;   /* the timeline says when the first ship is due */
+
+    while (!atomic_load(&game->game_over)) {
+        int64_t now = game_now_ms(game);
+        script_feed(sc, game, now);
+        if (replay) replay_feed(replay, game, now);
+        if (game->piloto) autopilot_passo(game->piloto, game, now);
+        game_drenar_eventos(game, NULL);
+        if (game->gravador) replay_drenar(game->gravador);
+        if (game_check_end(game)) break;
+        game_spawn_tick(game, now, &next_spawn);
+        recarga_tick(game, now);
+
+        int64_t t0 = mono_ns();
+        rep->passos += sim_tick(game, now);
+        int64_t dt = mono_ns() - t0;
+
+        if (rep->ticks == lat->cap && lat->cap < HEADLESS_LAT_MAX) {
+            long cap = lat->cap ? lat->cap * 2 : 4096;
+            uint32_t* l = (uint32_t*)realloc(lat->v, sizeof(uint32_t) * (size_t)cap);
+            if (l) { lat->v = l; lat->cap = cap; }
+        }
+        if (rep->ticks < lat->cap) lat->v[rep->ticks] = (dt > UINT32_MAX) ? UINT32_MAX : (uint32_t)dt;
+        rep->ticks++;
+
+        game->relogio_ms += game->tick_ms;
+    }
+
+    game_drenar_eventos(game, NULL);
+    rep->sim_s += (double)(game_now_ms(game) - game->start_ms) / 1e3;
+    rep->vitorias += game_vitoria(game);
+    rep->pontos += game->pontuacao;
+    rep->destruidas += game->naves_destruidas;
+}
+
+int headless_run(GameState* game, const char* script_path, ReplayReader* replay, int rondas, HeadlessReport* rep) {
+    Script sc;
+    if (script_load(&sc, script_path) != 0) return -1;
+
+    memset(rep, 0, sizeof(*rep));
+    Latencias lat = { NULL, 0 };
+    int64_t reset_ns = 0;
+    int64_t t_start = mono_ns();
+
+    for (int r = 0; r < rondas; r++) {
+        if (r > 0) {
+            int64_t t0 = mono_ns();
+            game_reset(game);
+            if (game->piloto) autopilot_reset(game->piloto, game);
+            script_rewind(&sc);
+            int64_t dt = mono_ns() - t0;
+            reset_ns += dt;
+            if (dt / 1e3 > rep->reset_us_max) rep->reset_us_max = dt / 1e3;
+        }
+        jogar_ronda(game, &sc, replay, rep, &lat);
+    }
+
+    rep->rondas = rondas;
+    rep->wall_s = (double)(mono_ns() - t_start) / 1e9;
+    if (rondas > 1) rep->reset_us_avg = reset_ns / 1e3 / (rondas - 1);
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0) rep->rss_kib = ru.ru_maxrss;
+
+    long n = (rep->ticks < lat.cap) ? rep->ticks : lat.cap;
+    if (n > 0) {
+        qsort(lat.v, (size_t)n, sizeof(uint32_t), cmp_u32);
+        rep->tick_p50_us = lat.v[(n - 1) / 2] / 1e3;
+        rep->tick_p99_us = lat.v[(n - 1) * 99 / 100] / 1e3;
+    }
+    free(lat.v);
+    free(sc.ev);
+    return 0;
+}
+
+void headless_print(const GameState* game, const HeadlessReport* rep) {
+    double wall = (rep->wall_s > 0) ? rep->wall_s : 1e-9;
+    const char* result = game_vitoria(game) ? "VICTORY" : "DEFEAT";
+
+    printf("%-6s ships=%-6d tick=%dms  sim %.1fs in %.3fs wall (%.0fx)\n",
+           game->cfg.name, game->naves_total, game->tick_ms,
+           rep->sim_s, rep->wall_s, rep->sim_s / wall);
+    printf("  ticks/s %.0f  steps/s %.0f  collisions/s %.1f  tick p50 %.2fus p99 %.2fus\n",
+           rep->ticks / wall, rep->passos / wall, rep->destruidas / wall,
+           rep->tick_p50_us, rep->tick_p99_us);
+    printf("  score %d  destroyed %d  ground %d  shots %d  %s\n",
+           game->pontuacao, game->naves_destruidas, game->naves_chegaram,
+           game->shots_fired, result);
+    if (rep->rondas > 1) {
+        printf("  rounds %d  victories %d  score avg %.1f  reset avg %.2fus max %.2fus  max RSS %ld KiB\n",
+               rep->rondas, rep->vitorias, (double)rep->pontos / rep->rondas,
+               rep->reset_us_avg, rep->reset_us_max, rep->rss_kib);
+    }
+    if (game->piloto) {
+        const Autopilot* a = game->piloto;
+        printf("  autopilot %ld decisions  %ld shots  solve avg %.2fus max %.2fus\n",
+               a->decisoes, a->disparos, a->decisoes ? a->ns_total / 1e3 / a->decisoes : 0.0,
+               a->ns_max / 1e3);
+    }
+}
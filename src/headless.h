@@ -0,0 +1,49 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+/**
+ * headless.h - Deterministic simulation without a terminal
+ *
+ * Runs the SIM_TICK simulation, spawner and reloader on the virtual clock,
+ * one tick_ms step per iteration and as fast as the CPU allows. Input comes
+ * from an optional script file, one event per line:
+ *
+ *     <time_ms> <key> [<count> <every_ms>]
+ *
+ * where <key> is a single character or one of space/left/right/up/esc;
+ * the optional pair repeats the key <count> times, <every_ms> apart.
+ * Blank lines and lines starting with '#' are ignored.
+ *
+ * Input can also come from a recorded session (replay.h), fed at the
+ * times it was recorded.
+ */
+
+#include "game.h"
+#include "replay.h"
+
+typedef struct {
+    int    rondas;
+    int    vitorias;
+    long   pontos;          /* score summed over the rounds */
+    long   destruidas;      /* kills summed over the rounds */
+    double reset_us_avg;    /* game_reset between rounds */
+    double reset_us_max;
+    long   rss_kib;         /* peak resident set at the end */
+    long   ticks;
+    long   passos;          /* entity steps across all ticks */
+    double wall_s;          /* real time spent in the loop */
+    double sim_s;           /* virtual time simulated */
+    double tick_p50_us;
+    double tick_p99_us;
+} HeadlessReport;
+
+/* Plays `rondas` rounds back to back, game_reset in between (the script
+   restarts with every round); script_path and replay may be NULL, replay
+   only with one round. Tick latency percentiles cover the first
+   HEADLESS_LAT_MAX ticks. Returns 0, or -1 if the script can't be read. */
+#define HEADLESS_LAT_MAX (1L << 20)
+
+int  headless_run(GameState* game, const char* script_path, ReplayReader* replay, int rondas, HeadlessReport* rep);
+void headless_print(const GameState* game, const HeadlessReport* rep);
+
+#endif /* HEADLESS_H */
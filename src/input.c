@@ -3,14 +3,17 @@
  */
  #include "input.h"
  #include "game.h"
+ #include "prof.h"
+ #include "replay.h"
  #include <ncurses.h>
  #include <stdatomic.h>
  #include <pthread.h>
  
- void process_input(GameState* game, int key) {
-     pthread_mutex_lock(&game->mutex_estado);
+ bool process_input(GameState* game, int key) {
+     replay_tecla(game, key);
+     int sw = game_metricas(game).w;
  
-     int sw = game->screen_width;
+     LOCK(game, estado);
  
      switch (key) {
          case 'a': case 'A': case KEY_LEFT:
@@ -30,15 +33,19 @@
          case 'c': case 'C':
              game->direcao_atual = DIR_HORIZONTAL_DIR; break;
          case ' ':
-             pthread_mutex_unlock(&game->mutex_estado);
+             UNLOCK(game, estado);
              /* Fire outside this lock (it takes others); shot counted in tentar_disparar */
-             (void)tentar_disparar(game);
-             return;
+             return tentar_disparar(game);
+         case 'p': case 'P':
+             prof_alternar(); break;
          case 'x': case 'X': case 27:
-             atomic_store(&game->game_over, true);
+             atomic_store(&game->game_over, true);   /* estado held: game_encerrar inline */
+             atomic_store(&game->encerrado, true);
+             pthread_cond_broadcast(&game->cond_game_over);
              break;
      }
  
-     pthread_mutex_unlock(&game->mutex_estado);
+     UNLOCK(game, estado);
+     return false;
  }
  
\ No newline at end of file
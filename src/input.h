@@ -3,6 +3,7 @@
 
 #include "game.h"
 
-void process_input(GameState* game, int key);
+/* Applies one key; true if it fired a rocket */
+bool process_input(GameState* game, int key);
 
 #endif /* INPUT_H */
@@ -4,52 +4,260 @@
  #include "game.h"
  #include "threads.h"
  #include "render.h"
+ #include "headless.h"
+ #include "replay.h"
+ #include "spectate.h"
+ #include "autopilot.h"
+ #include "config.h"
+ #include "pool.h"
+ #include "prof.h"
+ #include "affinity.h"
  #include <stdio.h>
  #include <stdlib.h>
- #include <time.h>
+ #include <string.h>
  #include <unistd.h>
  
  static void print_usage(const char* program_name) {
-     printf("Usage: %s [difficulty]\n\n", program_name);
+     printf("Usage: %s [options] [difficulty | profile]\n\n", program_name);
      printf("  0 - Easy   (30 ships, 2–3s spawn, 4 launchers, 2500ms reload)\n");
      printf("  1 - Medium (40 ships, 2s spawn,    7 launchers, 1500ms reload)\n");
-     printf("  2 - Hard   (60 ships, 1–2s spawn, 12 launchers,  800ms reload)\n\n");
+     printf("  2 - Hard   (60 ships, 1–2s spawn, 12 launchers,  800ms reload)\n");
+     printf("  3+ / name  Profiles from --config, by number or name\n\n");
+     printf("Options:\n");
+     printf("  --tick         Single-loop simulation instead of pooled per-entity steps\n");
+     printf("  --tick-ms N    Tick period for --tick (default %d ms)\n", DEF_TICK_MS);
+     printf("  --swept        Whole ticks with swept collision (--tick/--headless; any --tick-ms)\n");
+     printf("  --max-ships N  Ship pool capacity (default %d)\n", DEF_MAX_NAVES);
+     printf("  --max-rockets N  Rocket pool capacity (default %d)\n", DEF_MAX_FOGUETES);
+     printf("  --diff-render  Write only changed cells to the ncurses pad\n");
+     printf("  --ansi         Write frames as raw escape sequences, one write() each\n");
+     printf("  --fps N        Render target frame rate, 0 = uncapped (default %d)\n", DEF_FPS);
+     printf("  --interp       Interpolate entity positions between simulation steps\n");
+     printf("  --headless     Run without a terminal on a virtual clock (implies --tick)\n");
+     printf("  --script FILE  Scripted input for --headless (\"time_ms key [count every_ms]\")\n");
+     printf("  --seed N       PRNG seed (default: from the clock)\n");
+     printf("  --ships N      Total ships to spawn (default: difficulty preset)\n");
+     printf("  --spawn-ms N   Fixed spawn interval (default: difficulty preset)\n");
+     printf("  --config FILE  Load extra difficulty profiles (INI sections, see src/config.h)\n");
+     printf("  --rounds N     Play N rounds back to back, 0 = until quit (default 1)\n");
+     printf("  --autopilot    Let the built-in gunner play (load tests, headless benchmarks)\n");
+     printf("  --prof         Start with the profiler on (P toggles it; summary at exit)\n");
+     printf("  --pin-render CPU  Pin the renderer to CPU; other threads keep off it\n");
+     printf("  --pin-input CPU   Pin the input thread to CPU; other threads keep off it\n");
+     printf("  --rt PRIO      SCHED_FIFO priority for renderer and input (nice %d if refused)\n", AFIN_NICE);
+     printf("  --record FILE  Record the session (seed, settings, input) to FILE\n");
+     printf("  --replay FILE  Play a recorded session back headless, as fast as possible\n");
+     printf("  --serve PORT   Stream the session to TCP spectators on PORT\n");
+     printf("  --watch HOST:PORT  Watch a session streamed with --serve\n\n");
      printf("Rules:\n");
      printf("  • Game ends when all ships are handled (destroyed or reached ground),\n");
      printf("    OR immediately if more than half the total ships reach the ground.\n");
      printf("  • Victory requires destroying at least half of the total ships.\n\n");
      printf("Controls:\n");
-     printf("  A/D  Move | W/Q/E/Z/C Direction | SPACE Fire | X/ESC Quit\n\n");
+     printf("  A/D  Move | W/Q/E/Z/C Direction | SPACE Fire | P Profiler | X/ESC Quit\n\n");
  }
  
  int main(int argc, char* argv[]) {
-     int dificuldade = 1;
-     if (argc > 1) {
-         if (argv[1][0] == '-' && argv[1][1] == 'h') { print_usage(argv[0]); return 0; }
-         dificuldade = atoi(argv[1]);
-         if (dificuldade < 0 || dificuldade > 2) { fprintf(stderr,"Invalid difficulty.\n"); return 1; }
+     GameOptions opts = { .dificuldade = 1, .sim_mode = SIM_THREADS, .tick_ms = DEF_TICK_MS, .fps = DEF_FPS };
+     const char* script = NULL;
+     const char* config = NULL;       /* --config */
+     const char* perfil = "1";        /* positional difficulty or profile name */
+     const char* gravar = NULL;       /* --record */
+     const char* reproduzir = NULL;   /* --replay */
+     const char* assistir = NULL;     /* --watch */
+     int porta = 0;                   /* --serve */
+     bool autopiloto = false;         /* --autopilot */
+     int rondas = 1;                  /* --rounds, 0 = until quit */
+     AfinOpcoes afin = { .cpu = { -1, -1 } };   /* --pin-render, --pin-input, --rt */
+     for (int i = 1; i < argc; i++) {
+         const char* a = argv[i];
+         if (strcmp(a, "--tick") == 0) {
+             opts.sim_mode = SIM_TICK;
+         } else if (strcmp(a, "--swept") == 0) {
+             opts.varrido = true;
+         } else if (strcmp(a, "--tick-ms") == 0 && i + 1 < argc) {
+             opts.tick_ms = atoi(argv[++i]);
+             if (opts.tick_ms <= 0) { fprintf(stderr, "Invalid tick period.\n"); return 1; }
+         } else if (strcmp(a, "--max-ships") == 0 && i + 1 < argc) {
+             opts.max_naves = atoi(argv[++i]);
+             if (opts.max_naves <= 0 || opts.max_naves > POOL_LIMIT) { fprintf(stderr, "Invalid ship capacity.\n"); return 1; }
+         } else if (strcmp(a, "--max-rockets") == 0 && i + 1 < argc) {
+             opts.max_foguetes = atoi(argv[++i]);
+             if (opts.max_foguetes <= 0 || opts.max_foguetes > POOL_LIMIT) { fprintf(stderr, "Invalid rocket capacity.\n"); return 1; }
+         } else if (strcmp(a, "--diff-render") == 0) {
+             render_set_mode(RENDER_DIFF);
+         } else if (strcmp(a, "--ansi") == 0) {
+             render_set_backend(RENDER_ANSI);
+         } else if (strcmp(a, "--fps") == 0 && i + 1 < argc) {
+             opts.fps = atoi(argv[++i]);
+             if (opts.fps < 0 || opts.fps > 1000) { fprintf(stderr, "Invalid frame rate.\n"); return 1; }
+         } else if (strcmp(a, "--interp") == 0) {
+             render_set_interp(true);
+         } else if (strcmp(a, "--rounds") == 0 && i + 1 < argc) {
+             rondas = atoi(argv[++i]);
+             if (rondas < 0) { fprintf(stderr, "Invalid round count.\n"); return 1; }
+         } else if (strcmp(a, "--autopilot") == 0) {
+             autopiloto = true;
+         } else if (strcmp(a, "--prof") == 0) {
+             prof_set(true);
+         } else if ((strcmp(a, "--pin-render") == 0 || strcmp(a, "--pin-input") == 0) && i + 1 < argc) {
+             int cpu = atoi(argv[++i]);
+             if (cpu < 0) { fprintf(stderr, "Invalid CPU.\n"); return 1; }
+             afin.cpu[strcmp(a, "--pin-render") == 0 ? AFIN_RENDER : AFIN_INPUT] = cpu;
+         } else if (strcmp(a, "--rt") == 0 && i + 1 < argc) {
+             afin.rt_prio = atoi(argv[++i]);
+             if (afin.rt_prio < 1 || afin.rt_prio > 99) { fprintf(stderr, "Invalid real-time priority (1-99).\n"); return 1; }
+         } else if (strcmp(a, "--headless") == 0) {
+             opts.headless = true;
+         } else if (strcmp(a, "--script") == 0 && i + 1 < argc) {
+             script = argv[++i];
+         } else if (strcmp(a, "--config") == 0 && i + 1 < argc) {
+             config = argv[++i];
+         } else if (strcmp(a, "--record") == 0 && i + 1 < argc) {
+             gravar = argv[++i];
+         } else if (strcmp(a, "--replay") == 0 && i + 1 < argc) {
+             reproduzir = argv[++i];
+         } else if (strcmp(a, "--serve") == 0 && i + 1 < argc) {
+             porta = atoi(argv[++i]);
+             if (porta <= 0 || porta > 65535) { fprintf(stderr, "Invalid port.\n"); return 1; }
+         } else if (strcmp(a, "--watch") == 0 && i + 1 < argc) {
+             assistir = argv[++i];
+         } else if (strcmp(a, "--seed") == 0 && i + 1 < argc) {
+             opts.seed = strtoull(argv[++i], NULL, 0);
+             if (opts.seed == 0) { fprintf(stderr, "Invalid seed.\n"); return 1; }
+         } else if (strcmp(a, "--ships") == 0 && i + 1 < argc) {
+             opts.ships = atoi(argv[++i]);
+             if (opts.ships <= 0) { fprintf(stderr, "Invalid ship count.\n"); return 1; }
+         } else if (strcmp(a, "--spawn-ms") == 0 && i + 1 < argc) {
+             opts.spawn_ms = atoi(argv[++i]);
+             if (opts.spawn_ms <= 0) { fprintf(stderr, "Invalid spawn interval.\n"); return 1; }
+         } else if (a[0] == '-' && a[1] == 'h') {
+             print_usage(argv[0]); return 0;
+         } else if (a[0] == '-' && a[1] == '-') {
+             fprintf(stderr, "Unknown option: %s\n", a); return 1;
+         } else {
+             perfil = a;
+         }
      }
  
-     srand((unsigned)time(NULL));
+     /* Profiles: built-in presets, then the config file's; resolved once all
+        options are in, so --config may come after the difficulty */
+     PerfilTabela perfis;
+     config_padrao(&perfis);
+     if (config && config_carregar(&perfis, config) != 0) return 1;
+     opts.dificuldade = config_procurar(&perfis, perfil);
+     if (opts.dificuldade < 0) { fprintf(stderr, "Invalid difficulty or unknown profile: %s\n", perfil); return 1; }
+     opts.perfil = &perfis.perfis[opts.dificuldade];
  
+     if (script && reproduzir) { fprintf(stderr, "--script and --replay are exclusive.\n"); return 1; }
+     if (afin_pedido(&afin) && (assistir || reproduzir || opts.headless)) {
+         fprintf(stderr, "--pin-render, --pin-input and --rt need the terminal UI.\n");
+         return 1;
+     }
+ 
+     /* A viewer runs no game of its own */
+     if (assistir) return spect_assistir(assistir, &opts) == 0 ? 0 : 1;
+ 
+     if (script && !opts.headless) { fprintf(stderr, "--script requires --headless.\n"); return 1; }
+     if (rondas != 1 && (gravar || reproduzir)) { fprintf(stderr, "--rounds does not combine with --record or --replay.\n"); return 1; }
+     if (rondas == 0 && opts.headless) { fprintf(stderr, "--headless needs a finite --rounds.\n"); return 1; }
+     if (opts.varrido && !opts.headless && !reproduzir && opts.sim_mode != SIM_TICK) { fprintf(stderr, "--swept needs --tick or --headless.\n"); return 1; }
+     if (porta && (opts.headless || reproduzir)) { fprintf(stderr, "--serve needs the terminal UI (no --headless or --replay).\n"); return 1; }
+ 
+     /* A replay carries its own seed and settings; it overrides the command
+        line. From here on every failure unwinds through the falha_* ladder. */
      GameState game;
-     game_init(&game, dificuldade);
+     ReplayReader replay;
+     ReplayWriter gravador;
+     Autopilot piloto;
+     if (reproduzir && replay_abrir(&replay, reproduzir, &opts) != 0) return 1;
+ 
+     if (game_init(&game, &opts) != 0) {
+         fprintf(stderr, "Failed to allocate game state\n");
+         goto falha_game;
+     }
+ 
+     if (gravar) {
+         if (replay_gravar_abrir(&gravador, gravar, &game) != 0) goto falha_gravador;
+         game.gravador = &gravador;
+     }
+ 
+     if (autopiloto) {
+         if (autopilot_init(&piloto, &game) != 0) {
+             fprintf(stderr, "Failed to allocate autopilot\n");
+             goto falha_piloto;
+         }
+         game.piloto = &piloto;
+     }
+ 
+     if (opts.headless) {
+         HeadlessReport rep;
+         int rc = headless_run(&game, script, reproduzir ? &replay : NULL, rondas, &rep);
+         if (rc == 0) headless_print(&game, &rep);
+         if (rc == 0 && prof_usado()) prof_dump(stdout);
+         if (reproduzir) replay_fechar(&replay);
+         if (gravar) replay_gravar_fechar(&gravador);
+         if (autopiloto) autopilot_free(&piloto);
+         game_cleanup(&game);
+         return rc == 0 ? 0 : 1;
+     }
+ 
+     /* Before the first thread: every thread started from here on inherits
+        a mask without the pinned cores */
+     if (afin_preparar(&afin) != 0) goto falha_espect;
+
+     if (porta && !(game.espect = spect_iniciar(porta, &game))) goto falha_espect;
  
      render_init();
  
-     if (pthread_create(&game.thread_input, NULL, thread_input, &game) != 0) {
+     /* Thread model: ship/rocket steps run on a pool, one worker per core */
+     if (game.sim_mode == SIM_THREADS) {
+         game.pool = (WorkerPool*)malloc(sizeof(WorkerPool));
+         int workers = afin_nucleos_partilhados();
+         if (workers <= 0 || workers > pool_num_cores()) workers = pool_num_cores();
+         if (!game.pool || pool_init(game.pool, workers, game.cap_naves + game.cap_foguetes) != 0) {
+             free(game.pool); game.pool = NULL;
+             fprintf(stderr, "Failed to start worker pool\n");
+             goto falha_render;
+         }
+     }
+     if (thread_criar(&game.thread_input, thread_input, &game) != 0) {
          fprintf(stderr, "Failed to create input thread\n");
-         render_cleanup(); game_cleanup(&game); return 1;
+         goto falha_pool;
      }
-     if (pthread_create(&game.thread_artilheiro, NULL, thread_artilheiro, &game) != 0) {
+     if (thread_criar(&game.thread_artilheiro, thread_artilheiro, &game) != 0) {
          fprintf(stderr, "Failed to create loader thread\n");
-         render_cleanup(); game_cleanup(&game); return 1;
+         avisar_threads(&game);
+         goto falha_input;
+     }
+     if (game.sim_mode == SIM_TICK &&
+         thread_criar(&game.thread_simulacao, thread_simulacao, &game) != 0) {
+         fprintf(stderr, "Failed to create simulation thread\n");
+         avisar_threads(&game);
+         goto falha_artilheiro;
      }
  
-     thread_principal(&game);
+     afin_aplicar(AFIN_RENDER);   /* the main thread renders */
+
+     /* --rounds: the same state, screen and threads for every round */
+     int jogadas = 0, vitorias = 0;
+     for (;;) {
+         thread_principal(&game);
+         game_drenar_eventos(&game, render_add_explosion);
+         jogadas++;
+         vitorias += game_vitoria(&game);
+         if (atomic_load(&game.encerrado) || (rondas > 0 && jogadas >= rondas)) break;
+         game_reset(&game);
+         if (autopiloto) autopilot_reset(&piloto, &game);
+     }
      finalizar_threads(&game);
+     spect_parar(game.espect);   /* after the renderer's last publish */
+     game.espect = NULL;
+     game_drenar_eventos(&game, NULL);   /* producers are gone: count the tail */
+     if (gravar) replay_gravar_fechar(&gravador);
  
      render_cleanup();
+     if (autopiloto) autopilot_free(&piloto);
      game_cleanup(&game);
  
      printf("\n========================================\n");
@@ -64,15 +272,40 @@
      printf("Shots: %d | Hits: %d | Accuracy: %.1f%%\n", shots, hits, acc);
      printf("Best Streak: %d\n", game.best_streak);
      printf("Time: %ds\n", game.elapsed_sec);
-     if (game.naves_chegaram > game.naves_total / 2) {
-         printf("*** DEFEAT! (too many reached ground) ***\n");
-     } else if (game.naves_destruidas >= game.naves_total / 2) {
+     printf("Frames: %d rendered, %d skipped\n", game.frames_rendered, game.frames_skipped);
+     if (rondas != 1) printf("Rounds: %d played, %d won (last one above)\n", jogadas, vitorias);
+     if (game_vitoria(&game)) {
          printf("*** VICTORY! ***\n");
+     } else if (game.naves_chegaram > game.naves_total / 2) {
+         printf("*** DEFEAT! (too many reached ground) ***\n");
      } else {
          printf("*** DEFEAT! (destroyed less than half) ***\n");
      }
      printf("========================================\n\n");
+     afin_relatorio(stdout);
+     if (prof_usado()) prof_dump(stdout);
  
      return 0;
+
+     /* A partial start unwinds in reverse: every thread that did start has
+        been told to stop (avisar_threads) and is joined here */
+ falha_artilheiro:
+     pthread_join(game.thread_artilheiro, NULL);
+ falha_input:
+     pthread_join(game.thread_input, NULL);
+ falha_pool:
+     if (game.pool) pool_parar(game.pool);
+ falha_render:
+     render_cleanup();
+     spect_parar(game.espect);
+ falha_espect:
+     if (autopiloto) autopilot_free(&piloto);
+ falha_piloto:
+     if (gravar) replay_gravar_fechar(&gravador);
+ falha_gravador:
+     game_cleanup(&game);
+ falha_game:
+     if (reproduzir) replay_fechar(&replay);
+     return 1;
  }
  
\ No newline at end of file
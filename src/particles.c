@@ -0,0 +1,124 @@
+/**
+ * particles.c - Particle pool and timing wheel (see particles.h)
+ */
+#include "particles.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define MASCARA_RODA (PART_RODA - 1)
+
+int part_init(Particulas* p, int cap) {
+    memset(p, 0, sizeof(*p));
+    for (int b = 0; b < PART_RODA; b++) p->roda[b] = -1;
+    p->livre = -1;   /* empty pool: every emit is dropped */
+    if (cap < 1 || cap > PART_MAX_CAP) return -1;
+    const size_t n = (size_t)cap;
+    p->x = (int32_t*)malloc(sizeof(int32_t) * n);
+    p->y = (int32_t*)malloc(sizeof(int32_t) * n);
+    p->vx = (int32_t*)malloc(sizeof(int32_t) * n);
+    p->vy = (int32_t*)malloc(sizeof(int32_t) * n);
+    p->fim = (unsigned*)malloc(sizeof(unsigned) * n);
+    p->geracao = (uint16_t*)malloc(sizeof(uint16_t) * n);
+    p->prox = (int*)malloc(sizeof(int) * n);
+    p->ant = (int*)malloc(sizeof(int) * n);
+    p->tipo = (unsigned char*)malloc(n);
+    p->glifo = (char*)malloc(n);
+    if (!p->x || !p->y || !p->vx || !p->vy || !p->fim || !p->geracao || !p->prox || !p->ant ||
+        !p->tipo || !p->glifo) {
+        part_free(p);
+        return -1;
+    }
+    p->cap = cap;
+    for (int i = 0; i < cap; i++) p->geracao[i] = 1;
+    part_limpar(p);
+    return 0;
+}
+
+void part_free(Particulas* p) {
+    free(p->x); free(p->y); free(p->vx); free(p->vy);
+    free(p->fim); free(p->geracao); free(p->prox); free(p->ant);
+    free(p->tipo); free(p->glifo);
+    memset(p, 0, sizeof(*p));
+    for (int b = 0; b < PART_RODA; b++) p->roda[b] = -1;
+    p->livre = -1;
+}
+
+/* Frees slot i (already unlinked): a new generation, back on the stack */
+static void liberar(Particulas* p, int i) {
+    if (++p->geracao[i] == 0) p->geracao[i] = 1;
+    p->prox[i] = p->livre;
+    p->livre = i;
+    p->vivas--;
+}
+
+void part_limpar(Particulas* p) {
+    PART_FOR_EACH(p, i) if (++p->geracao[i] == 0) p->geracao[i] = 1;
+    for (int b = 0; b < PART_RODA; b++) p->roda[b] = -1;
+    for (int i = 0; i < p->cap; i++) p->prox[i] = (i + 1 < p->cap) ? i + 1 : -1;
+    p->livre = p->cap ? 0 : -1;
+    p->vivas = 0;
+}
+
+static void ligar(Particulas* p, int i) {
+    int* cabeca = &p->roda[p->fim[i] & MASCARA_RODA];
+    p->ant[i] = -1;
+    p->prox[i] = *cabeca;
+    if (*cabeca >= 0) p->ant[*cabeca] = i;
+    *cabeca = i;
+}
+
+static void desligar(Particulas* p, int i) {
+    if (p->ant[i] >= 0) p->prox[p->ant[i]] = p->prox[i];
+    else p->roda[p->fim[i] & MASCARA_RODA] = p->prox[i];
+    if (p->prox[i] >= 0) p->ant[p->prox[i]] = p->ant[i];
+}
+
+/* Keeps every lifetime inside one turn of the wheel, so a bucket only ever
+   holds the particles that expire on the same frame */
+static inline int vida_valida(int vida) {
+    return (vida < 1) ? 1 : (vida > PART_RODA - 1 ? PART_RODA - 1 : vida);
+}
+
+ParticulaId part_emitir(Particulas* p, ParticulaTipo tipo, int x, int y, int vx, int vy,
+                        int vida, char glifo) {
+    if (p->livre < 0) {
+        p->descartadas++;
+        return PART_NENHUMA;
+    }
+    const int i = p->livre;
+    p->livre = p->prox[i];
+    p->x[i] = x * PART_UM + PART_UM / 2;   /* cell centre */
+    p->y[i] = y * PART_UM + PART_UM / 2;
+    p->vx[i] = vx;
+    p->vy[i] = vy;
+    p->tipo[i] = (unsigned char)tipo;
+    p->glifo[i] = glifo;
+    p->fim[i] = p->quadro + (unsigned)vida_valida(vida);
+    ligar(p, i);
+    p->vivas++;
+    return ((ParticulaId)p->geracao[i] << 16) | (ParticulaId)i;
+}
+
+void part_renovar(Particulas* p, ParticulaId id, int vida) {
+    if (!part_viva(p, id)) return;
+    const int i = (int)(id & 0xFFFFu);
+    desligar(p, i);
+    p->fim[i] = p->quadro + (unsigned)vida_valida(vida);
+    ligar(p, i);
+}
+
+void part_avancar(Particulas* p) {
+    p->quadro++;
+    int* cabeca = &p->roda[p->quadro & MASCARA_RODA];
+    for (int i = *cabeca, prox; i >= 0; i = prox) {
+        prox = p->prox[i];
+        liberar(p, i);
+    }
+    *cabeca = -1;
+
+    PART_FOR_EACH(p, i) {
+        p->x[i] += p->vx[i];
+        p->y[i] += p->vy[i];
+        if (p->tipo[i] == PART_DETRITO) p->vy[i] += PART_GRAVIDADE;
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef PARTICLES_H
+#define PARTICLES_H
+
+/**
+ * particles.h - Pooled particle effects (explosions, debris, rocket trails)
+ *
+ * A fixed pool of slots in structure-of-arrays form. Free slots form a
+ * stack; live ones hang off a timing wheel of PART_RODA buckets keyed by
+ * the frame they expire on (intrusive doubly-linked lists), so emitting,
+ * renewing and expiring a particle are O(1) each and a frame only visits
+ * the bucket that is due. Ages count rendered frames.
+ *
+ * Every slot carries a generation that changes when it is freed, and a
+ * handle is (generation << 16 | slot): a handle kept after its particle
+ * expired is simply no longer alive, and never aliases the slot's next
+ * tenant (the renderer keeps one per screen cell to merge rocket trails).
+ *
+ * Renderer thread only. Gameplay code reaches it through the lock-free
+ * event ring (game_evento), which the main loop drains every frame; a full
+ * pool drops the new particle, so nothing on this path ever waits.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PART_RODA     32        /* wheel buckets (power of two); lifetimes are 1..PART_RODA-1 frames */
+#define PART_MAX_CAP  65535     /* slot index must fit the low 16 bits of a handle */
+#define PART_UM       256       /* positions and velocities: 8.8 fixed-point cells (per frame) */
+#define PART_GRAVIDADE 24       /* debris: added to vy every frame */
+
+typedef uint32_t ParticulaId;
+#define PART_NENHUMA 0u         /* generations start at 1, so never a live handle */
+
+typedef enum {
+    PART_EXPLOSAO,   /* burst drawn as a cross around its cell */
+    PART_DETRITO,    /* one glyph, ballistic */
+    PART_RASTRO      /* one glyph left behind a rocket */
+} ParticulaTipo;
+
+typedef struct {
+    int cap;
+    int32_t* x;            /* [cap] 8.8 */
+    int32_t* y;
+    int32_t* vx;           /* [cap] 8.8 per frame */
+    int32_t* vy;
+    unsigned* fim;         /* [cap] expiry frame */
+    uint16_t* geracao;     /* [cap] 1..65535 */
+    int* prox;             /* [cap] next in bucket, or in the free stack */
+    int* ant;              /* [cap] previous in bucket, -1 at the head */
+    unsigned char* tipo;   /* [cap] ParticulaTipo */
+    char* glifo;
+    int roda[PART_RODA];   /* bucket heads by fim % PART_RODA, -1 if empty */
+    int livre;             /* free stack head, -1 when full */
+    unsigned quadro;       /* frames advanced */
+    int vivas;
+    long descartadas;      /* emits dropped on a full pool */
+} Particulas;
+
+int  part_init(Particulas* p, int cap);   /* 0 on success */
+void part_free(Particulas* p);
+void part_limpar(Particulas* p);          /* kills everything, keeps the storage */
+
+/* New particle at cell (x, y) moving (vx, vy) 8.8 cells per frame for
+   `vida` frames; PART_NENHUMA if the pool is full */
+ParticulaId part_emitir(Particulas* p, ParticulaTipo tipo, int x, int y, int vx, int vy,
+                        int vida, char glifo);
+
+static inline bool part_viva(const Particulas* p, ParticulaId id) {
+    const int i = (int)(id & 0xFFFFu);
+    return id != PART_NENHUMA && i < p->cap && p->geracao[i] == (uint16_t)(id >> 16);
+}
+
+/* Restarts a live particle's lifetime; no-op on a stale handle */
+void part_renovar(Particulas* p, ParticulaId id, int vida);
+
+/* One frame: expires what is due, then moves the rest */
+void part_avancar(Particulas* p);
+
+/* Cell of particle i (floor of its 8.8 position) */
+static inline int part_cx(const Particulas* p, int i) { return (int)((p->x[i] - (p->x[i] < 0 ? PART_UM - 1 : 0)) / PART_UM); }
+static inline int part_cy(const Particulas* p, int i) { return (int)((p->y[i] - (p->y[i] < 0 ? PART_UM - 1 : 0)) / PART_UM); }
+
+/* Iterate live particles (bucket order):  PART_FOR_EACH(p, i) { ... } */
+#define PART_FOR_EACH(p, i)                                      \
+    for (int pb_ = 0; pb_ < PART_RODA; pb_++)                     \
+    for (int i = (p)->roda[pb_]; i >= 0; i = (p)->prox[i])
+
+#endif /* PARTICLES_H */
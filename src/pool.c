@@ -0,0 +1,250 @@
+/**
+ * pool.c - Work-stealing worker pool with a timer heap (see pool.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "pool.h"
+#include "prof.h"
+#include <limits.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+int thread_criar(pthread_t* t, void* (*fn)(void*), void* arg) {
+    pthread_attr_t attr;
+    if (pthread_attr_init(&attr) != 0) return -1;
+    size_t stack = THREAD_STACK_SIZE;
+    if (stack < (size_t)PTHREAD_STACK_MIN) stack = (size_t)PTHREAD_STACK_MIN;
+    pthread_attr_setstacksize(&attr, stack);
+    int rc = pthread_create(t, &attr, fn, arg);
+    pthread_attr_destroy(&attr);
+    return rc;
+}
+
+int pool_num_cores(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    if (n < 1) n = 1;
+    if (n > POOL_MAX_WORKERS) n = POOL_MAX_WORKERS;
+    return (int)n;
+}
+
+static inline int64_t agora_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ========= Timer heap (pool->mtx) ========= */
+
+static void heap_push(WorkerPool* p, PoolTask t) {
+    int h = p->num_heap++;
+    while (h > 0) {
+        int pai = (h - 1) / 2;
+        if (p->heap[pai].prazo <= t.prazo) break;
+        p->heap[h] = p->heap[pai];
+        h = pai;
+    }
+    p->heap[h] = t;
+}
+
+static PoolTask heap_pop(WorkerPool* p) {
+    PoolTask top = p->heap[0];
+    PoolTask last = p->heap[--p->num_heap];
+    int n = p->num_heap, h = 0;
+    for (;;) {
+        int c = 2 * h + 1;
+        if (c >= n) break;
+        if (c + 1 < n && p->heap[c + 1].prazo < p->heap[c].prazo) c++;
+        if (last.prazo <= p->heap[c].prazo) break;
+        p->heap[h] = p->heap[c];
+        h = c;
+    }
+    if (n > 0) p->heap[h] = last;
+    return top;
+}
+
+/* ========= Deques (PoolWorker.mtx) ========= */
+
+static bool deque_pop(PoolWorker* w, PoolTask* out) {
+    bool ok = false;
+    pthread_mutex_lock(&w->mtx);
+    if (w->base != w->topo) {
+        *out = w->buf[--w->base & (POOL_DEQUE_CAP - 1)];
+        atomic_fetch_sub_explicit(&w->pool->listos, 1, memory_order_relaxed);
+        ok = true;
+    }
+    pthread_mutex_unlock(&w->mtx);
+    return ok;
+}
+
+static bool deque_steal(PoolWorker* w, PoolTask* out) {
+    bool ok = false;
+    pthread_mutex_lock(&w->mtx);
+    if (w->base != w->topo) {
+        *out = w->buf[w->topo++ & (POOL_DEQUE_CAP - 1)];
+        atomic_fetch_sub_explicit(&w->pool->listos, 1, memory_order_relaxed);
+        ok = true;
+    }
+    pthread_mutex_unlock(&w->mtx);
+    return ok;
+}
+
+static bool roubar(WorkerPool* p, int self, PoolTask* out) {
+    for (int i = 1; i < p->num_workers; i++) {
+        if (deque_steal(&p->workers[(self + i) % p->num_workers], out)) return true;
+    }
+    return false;
+}
+
+/* Caller holds p->mtx. Moves every due task (as many as fit) onto w's
+   deque, earliest at the bottom so the owner runs the most overdue first
+   and thieves take the later ones. Returns how many were moved. */
+static int migrar_vencidas(WorkerPool* p, PoolWorker* w, int64_t now) {
+    PoolTask lote[POOL_DEQUE_CAP];
+    pthread_mutex_lock(&w->mtx);
+    int livre = POOL_DEQUE_CAP - (int)(w->base - w->topo);
+    int n = 0;
+    while (n < livre && p->num_heap > 0 && p->heap[0].prazo <= now) lote[n++] = heap_pop(p);
+    for (int i = n - 1; i >= 0; i--) w->buf[w->base++ & (POOL_DEQUE_CAP - 1)] = lote[i];
+    pthread_mutex_unlock(&w->mtx);
+    if (n > 0) atomic_fetch_add_explicit(&p->listos, n, memory_order_relaxed);
+    return n;
+}
+
+/* ocupados is raised before the epoch check, so pool_descartar either
+   sees this task running or the task sees the new epoch */
+static void executar(WorkerPool* p, PoolTask* t) {
+    atomic_fetch_add(&p->ocupados, 1);
+    int64_t prox = (t->epoca == atomic_load(&p->epoca)) ? t->fn(t->ctx, t->arg) : -1;
+    if (prox >= 0) {
+        t->prazo = prox;
+        pthread_mutex_lock(&p->mtx);
+        bool primeiro = (p->num_heap == 0 || prox < p->heap[0].prazo);
+        heap_push(p, *t);
+        if (primeiro) pthread_cond_signal(&p->cond);   /* a sleeper may wait for a later one */
+        pthread_mutex_unlock(&p->mtx);
+    }
+    atomic_fetch_sub(&p->ocupados, 1);
+}
+
+static void* pool_worker(void* arg) {
+    PROF_THREAD_ENTER();
+    PoolWorker* w = (PoolWorker*)arg;
+    WorkerPool* p = w->pool;
+
+    for (;;) {
+        PoolTask t;
+        if (deque_pop(w, &t) || roubar(p, w->idx, &t)) {
+            executar(p, &t);
+            continue;
+        }
+
+        pthread_mutex_lock(&p->mtx);
+        if (p->parar) { pthread_mutex_unlock(&p->mtx); break; }
+        int n = migrar_vencidas(p, w, agora_ms());
+        if (n > 1) {
+            pthread_cond_broadcast(&p->cond);        /* let the others steal */
+        } else if (n == 0 && atomic_load_explicit(&p->listos, memory_order_relaxed) == 0) {
+            if (p->num_heap == 0) {
+                pthread_cond_wait(&p->cond, &p->mtx);
+            } else {
+                int64_t prazo = p->heap[0].prazo;
+                struct timespec ts = { .tv_sec = (time_t)(prazo / 1000), .tv_nsec = (long)(prazo % 1000) * 1000000L };
+                pthread_cond_timedwait(&p->cond, &p->mtx, &ts);
+            }
+        }
+        pthread_mutex_unlock(&p->mtx);
+    }
+    PROF_THREAD_EXIT();
+    return NULL;
+}
+
+int pool_init(WorkerPool* p, int workers, int cap) {
+    memset(p, 0, sizeof(*p));
+    if (workers < 1) workers = 1;
+    if (workers > POOL_MAX_WORKERS) workers = POOL_MAX_WORKERS;
+
+    p->heap = (PoolTask*)malloc(sizeof(PoolTask) * (size_t)(cap > 0 ? cap : 1));
+    p->workers = (PoolWorker*)calloc((size_t)workers, sizeof(PoolWorker));
+    if (!p->heap || !p->workers) {
+        free(p->heap); free(p->workers);
+        return -1;
+    }
+    p->cap_heap = cap;
+    atomic_init(&p->listos, 0);
+    atomic_init(&p->epoca, 0);
+    atomic_init(&p->ocupados, 0);
+
+    pthread_mutex_init(&p->mtx, NULL);
+    pthread_condattr_t ca;
+    pthread_condattr_init(&ca);
+    pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+    pthread_cond_init(&p->cond, &ca);
+    pthread_condattr_destroy(&ca);
+
+    for (int i = 0; i < workers; i++) {
+        PoolWorker* w = &p->workers[i];
+        pthread_mutex_init(&w->mtx, NULL);
+        w->pool = p;
+        w->idx = i;
+    }
+    /* Workers index each other's deques: publish the count before any starts */
+    p->num_workers = workers;
+    for (int i = 0; i < workers; i++) {
+        if (thread_criar(&p->workers[i].tid, pool_worker, &p->workers[i]) != 0) {
+            p->num_workers = i;      /* join only the ones that started */
+            pool_free(p);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void pool_submeter(WorkerPool* p, PoolFn fn, void* ctx, int arg, int64_t prazo) {
+    PoolTask t = { prazo, fn, ctx, arg, atomic_load(&p->epoca) };
+    pthread_mutex_lock(&p->mtx);
+    heap_push(p, t);
+    pthread_cond_signal(&p->cond);
+    pthread_mutex_unlock(&p->mtx);
+}
+
+void pool_descartar(WorkerPool* p) {
+    atomic_fetch_add(&p->epoca, 1);
+    while (atomic_load(&p->ocupados) > 0) sched_yield();   /* one entity step at most */
+
+    pthread_mutex_lock(&p->mtx);
+    p->num_heap = 0;
+    for (int i = 0; i < p->num_workers; i++) {
+        PoolWorker* w = &p->workers[i];
+        pthread_mutex_lock(&w->mtx);
+        atomic_fetch_sub_explicit(&p->listos, (int)(w->base - w->topo), memory_order_relaxed);
+        w->topo = w->base;
+        pthread_mutex_unlock(&w->mtx);
+    }
+    pthread_mutex_unlock(&p->mtx);
+}
+
+void pool_parar(WorkerPool* p) {
+    if (p->parado) return;
+    pthread_mutex_lock(&p->mtx);
+    p->parar = true;
+    pthread_cond_broadcast(&p->cond);
+    pthread_mutex_unlock(&p->mtx);
+    for (int i = 0; i < p->num_workers; i++) pthread_join(p->workers[i].tid, NULL);
+    p->parado = true;
+}
+
+void pool_free(WorkerPool* p) {
+    pool_parar(p);
+    if (p->workers) {
+        for (int i = 0; i < p->num_workers; i++) pthread_mutex_destroy(&p->workers[i].mtx);
+        pthread_mutex_destroy(&p->mtx);
+        pthread_cond_destroy(&p->cond);
+    }
+    free(p->workers);
+    free(p->heap);
+    p->workers = NULL;
+    p->heap = NULL;
+}
@@ -0,0 +1,89 @@
+#ifndef POOL_H
+#define POOL_H
+
+/**
+ * pool.h - Persistent worker pool for SIM_THREADS entity steps
+ *
+ * A fixed set of workers (one per online core) replaces the thread that
+ * used to be created for every ship and rocket. A task is one entity step:
+ * it runs, returns the time of its next step, and goes back to the timer
+ * heap until then. Due tasks are moved in batches onto the deque of the
+ * worker that noticed them; that worker pops from the bottom while idle
+ * workers steal from the top, so a burst of due steps spreads over every
+ * core. Deadlines are CLOCK_MONOTONIC milliseconds (game_now_ms outside
+ * headless mode).
+ */
+
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#define POOL_MAX_WORKERS 64
+#define POOL_DEQUE_CAP   256          /* per-worker ring, power of two */
+#define THREAD_STACK_SIZE (256 * 1024)  /* every thread we create (no 8 MB default) */
+
+/* One step; returns the absolute time (ms) of the next one, or -1 when done */
+typedef int64_t (*PoolFn)(void* ctx, int arg);
+
+typedef struct {
+    int64_t prazo;            /* due time, ms */
+    PoolFn fn;
+    void* ctx;
+    int arg;
+    unsigned epoca;           /* pool_descartar generation it was submitted in */
+} PoolTask;
+
+struct WorkerPool;
+
+typedef struct {
+    pthread_mutex_t mtx;      /* owner push/pop vs. thieves */
+    PoolTask buf[POOL_DEQUE_CAP];
+    unsigned topo, base;      /* thieves take topo, the owner works at base */
+    struct WorkerPool* pool;
+    int idx;
+    pthread_t tid;
+} PoolWorker;
+
+typedef struct WorkerPool {
+    PoolWorker* workers;
+    int num_workers;
+
+    pthread_mutex_t mtx;      /* timer heap, parar */
+    pthread_cond_t cond;      /* idle workers (CLOCK_MONOTONIC timedwait) */
+    PoolTask* heap;           /* min-heap on prazo */
+    int num_heap, cap_heap;
+    atomic_int listos;        /* tasks sitting in deques; raised under mtx */
+    atomic_uint epoca;        /* bumped by pool_descartar; older tasks never run */
+    atomic_int ocupados;      /* workers inside executar */
+    bool parar;
+    bool parado;              /* workers joined */
+} WorkerPool;
+
+/* pthread_create with a THREAD_STACK_SIZE stack */
+int thread_criar(pthread_t* t, void* (*fn)(void*), void* arg);
+
+/* Online cores, clamped to [1, POOL_MAX_WORKERS] */
+int pool_num_cores(void);
+
+/* Starts `workers` threads; `cap` bounds the tasks alive at once (every
+   submitted task that has not finished yet). 0 on success. */
+int  pool_init(WorkerPool* p, int workers, int cap);
+
+/* Queues fn(ctx, arg) to run at `prazo`; never blocks on a running task.
+   The caller guarantees fewer than `cap` tasks are alive. */
+void pool_submeter(WorkerPool* p, PoolFn fn, void* ctx, int arg, int64_t prazo);
+
+/* Shutdown: wakes and joins every worker; queued tasks are dropped */
+void pool_parar(WorkerPool* p);
+void pool_free(WorkerPool* p);
+
+/* Drops every queued task and waits out the ones running; the workers
+   stay up for the next pool_submeter. Must not hold a lock a task takes. */
+void pool_descartar(WorkerPool* p);
+
+#endif /* POOL_H */
@@ -0,0 +1,113 @@
+/**
+ * prof.c - Frame/tick profiler and lock-contention counters (see prof.h)
+ */
+#include "prof.h"
+
+atomic_bool prof_ativo = false;
+atomic_int  prof_threads = 1;            /* main thread */
+ProfMutexStats prof_mutex[PROF_NUM_MTX];
+ProfFaseStats  prof_fases[PROF_NUM_FASES];
+_Atomic uint64_t prof_lat[PROF_NUM_LAT][PROF_LAT_BALDES];
+
+static atomic_bool s_usado = false;
+static uint64_t s_t_inicio;              /* first enable */
+
+static const char* const MTX_NOMES[PROF_NUM_MTX] = { "naves", "foguetes", "estado", "lancadores", "render" };
+static const char* const FASE_NOMES[PROF_NUM_FASES] = { "snapshot", "draw", "doupdate", "tick", "autopilot" };
+static const char* const LAT_NOMES[PROF_NUM_LAT] = { "fire" };
+
+void prof_set(bool on) {
+    if (on && !atomic_exchange(&s_usado, true)) s_t_inicio = prof_now_ns();
+    atomic_store(&prof_ativo, on);
+}
+
+void prof_alternar(void) { prof_set(!prof_on()); }
+
+bool prof_usado(void) { return atomic_load(&s_usado); }
+
+static uint64_t ld(_Atomic uint64_t* v) { return atomic_load_explicit(v, memory_order_relaxed); }
+
+/* Middle of histogram bucket b, in ns */
+static double balde_ns(int b) {
+    if (b < 8) return b;
+    const int e = b / 8 + 2;
+    return (double)((uint64_t)(8 + b % 8) << (e - 3)) + (double)(1ULL << (e - 3)) / 2.0;
+}
+
+/* q-quantile of a histogram holding n samples (n > 0) */
+static double quantil_ns(const uint64_t* h, uint64_t n, double q) {
+    uint64_t alvo = (uint64_t)(q * (double)n), soma = 0;
+    if (alvo < 1) alvo = 1;
+    for (int b = 0; b < PROF_LAT_BALDES; b++)
+        if ((soma += h[b]) >= alvo) return balde_ns(b);
+    return balde_ns(PROF_LAT_BALDES - 1);
+}
+
+const char* prof_overlay(void) {
+    static char linha[256];
+    static uint64_t prox_ns;
+    static uint64_t fase_ns[PROF_NUM_FASES], fase_n[PROF_NUM_FASES];
+    static uint64_t mtx_wait[PROF_NUM_MTX];
+    static uint64_t lat_antes[PROF_LAT_BALDES];
+
+    uint64_t now = prof_now_ns();
+    if (now < prox_ns) return linha;
+    prox_ns = now + 500000000ULL;
+
+    double us[PROF_NUM_FASES];
+    for (int i = 0; i < PROF_NUM_FASES; i++) {
+        uint64_t t = ld(&prof_fases[i].total_ns), n = ld(&prof_fases[i].count);
+        us[i] = (n > fase_n[i]) ? (double)(t - fase_ns[i]) / (double)(n - fase_n[i]) / 1e3 : 0.0;
+        fase_ns[i] = t; fase_n[i] = n;
+    }
+    /* Key-to-rocket p99 over the window */
+    uint64_t lat[PROF_LAT_BALDES], n_lat = 0;
+    for (int b = 0; b < PROF_LAT_BALDES; b++) {
+        uint64_t v = ld(&prof_lat[PROF_LAT_DISPARO][b]);
+        lat[b] = v - lat_antes[b];
+        lat_antes[b] = v;
+        n_lat += lat[b];
+    }
+    const double fire_us = n_lat ? quantil_ns(lat, n_lat, 0.99) / 1e3 : 0.0;
+
+    int len = snprintf(linha, sizeof linha, "[prof] snap %.0fus draw %.0fus upd %.0fus tick %.0fus | fire p99 %.0fus | thr %d | wait ms/s",
+                       us[PROF_FASE_SNAP], us[PROF_FASE_DRAW], us[PROF_FASE_UPDATE], us[PROF_FASE_TICK],
+                       fire_us, atomic_load_explicit(&prof_threads, memory_order_relaxed));
+    for (int i = 0; i < PROF_NUM_MTX && len > 0 && (size_t)len < sizeof linha; i++) {
+        uint64_t w = ld(&prof_mutex[i].wait_ns);
+        /* window is 0.5 s: ns -> ms/s is / 1e6 * 2 */
+        len += snprintf(linha + len, sizeof linha - (size_t)len, " %.3s:%.1f",
+                        MTX_NOMES[i], (double)(w - mtx_wait[i]) * 2.0 / 1e6);
+        mtx_wait[i] = w;
+    }
+    return linha;
+}
+
+void prof_dump(FILE* f) {
+    double secs = (double)(prof_now_ns() - s_t_inicio) / 1e9;
+    fprintf(f, "Profiler (%.1fs):\n", secs);
+    for (int i = 0; i < PROF_NUM_FASES; i++) {
+        uint64_t t = ld(&prof_fases[i].total_ns), n = ld(&prof_fases[i].count);
+        if (n) fprintf(f, "  %-10s %8llu x  avg %8.1f us\n", FASE_NOMES[i],
+                       (unsigned long long)n, (double)t / (double)n / 1e3);
+    }
+    for (int i = 0; i < PROF_NUM_LAT; i++) {
+        uint64_t h[PROF_LAT_BALDES], n = 0;
+        int max = 0;
+        for (int b = 0; b < PROF_LAT_BALDES; b++) {
+            h[b] = ld(&prof_lat[i][b]);
+            n += h[b];
+            if (h[b]) max = b;
+        }
+        if (n) fprintf(f, "  %-10s %8llu x  p50 %8.1f us  p99 %8.1f us  max %8.1f us\n", LAT_NOMES[i],
+                       (unsigned long long)n, quantil_ns(h, n, 0.50) / 1e3, quantil_ns(h, n, 0.99) / 1e3,
+                       balde_ns(max) / 1e3);
+    }
+    fprintf(f, "  %-10s %12s %12s %12s\n", "mutex", "acquired", "contended", "wait ms");
+    for (int i = 0; i < PROF_NUM_MTX; i++) {
+        fprintf(f, "  %-10s %12llu %12llu %12.2f\n", MTX_NOMES[i],
+                (unsigned long long)ld(&prof_mutex[i].count),
+                (unsigned long long)ld(&prof_mutex[i].contended),
+                (double)ld(&prof_mutex[i].wait_ns) / 1e6);
+    }
+}
@@ -1,11 +1,29 @@
 /**
  * render.c - Flicker-free rendering with ncurses PAD + doupdate()
+ *
+ * Each frame is composed into a cell buffer (glyph + colour pair) and then
+ * emitted to the pad. RENDER_FULL erases the pad and emits every cell;
+ * RENDER_DIFF keeps the previous frame and emits only the cells that
+ * changed. doupdate() already sends the terminal only what changed in
+ * either mode, so RENDER_DIFF saves pad writes (werase + waddch per cell),
+ * not output. The static layer (ground, controls line, HUD labels) is
+ * composed once per resize. With RENDER_ANSI the canvas goes to the
+ * escape-sequence writer in term.c instead, which diffs against what the
+ * terminal shows and sends the frame in one write(); ncurses then only
+ * handles input.
  */
  #include "render.h"
  #include "game.h"
+ #include "snapshot.h"
+ #include "prof.h"
+ #include "term.h"
+ #include "particles.h"
  #include <ncurses.h>
+ #include <math.h>
+ #include <stdio.h>
  #include <string.h>
  #include <stdlib.h>
+ #include <stdint.h>
  #include <pthread.h>
  #include <stdatomic.h>
  
@@ -19,55 +37,86 @@
  #define CP_DIRECTION  7
  #define CP_TRAIL      8
  
- /* Explosions */
- typedef struct { int x, y, frames_left; } Explosion;
- #define MAX_EXPLOSIONS 32
- static Explosion s_expl[MAX_EXPLOSIONS];
- static int s_expl_count = 0;
- static pthread_mutex_t s_expl_mtx = PTHREAD_MUTEX_INITIALIZER;
+ /* Foreground of each pair, all on black */
+ static const short PAR_FG[] = {
+     [CP_SHIP] = COLOR_RED,          [CP_ROCKET] = COLOR_YELLOW,
+     [CP_BATTERY] = COLOR_CYAN,      [CP_HUD] = COLOR_WHITE,
+     [CP_EXPLOSION] = COLOR_MAGENTA, [CP_GROUND] = COLOR_GREEN,
+     [CP_DIRECTION] = COLOR_BLUE,    [CP_TRAIL] = COLOR_YELLOW,
+ };
+ #define NUM_PARES (int)(sizeof(PAR_FG) / sizeof(PAR_FG[0]))
+ 
+ /* Effects: pooled particles (particles.h) aged once per rendered frame.
+    Renderer thread only: explosions come from the event drain in
+    thread_principal, trails from the rockets of each frame. */
+ #define FX_CAP        8192
+ #define EXPL_FRAMES   5     /* burst */
+ #define DETRITOS      6     /* debris per explosion */
+ #define RASTRO_FRAMES 4     /* trail cell */
+ static Particulas s_fx;
+ static ParticulaId* s_rastro = NULL;   /* [cell] trail there, renewed instead of duplicated */
+ static uint32_t s_fx_semente = 0x9E3779B9u;
  
  /* Off-screen pad */
  static WINDOW* s_pad = NULL;
  static int s_pad_w = 0, s_pad_h = 0;
  
- static void expl_add(int x, int y) {
-     pthread_mutex_lock(&s_expl_mtx);
-     if (s_expl_count < MAX_EXPLOSIONS) {
-         s_expl[s_expl_count].x = x;
-         s_expl[s_expl_count].y = y;
-         s_expl[s_expl_count].frames_left = 5;
-         s_expl_count++;
-     }
-     pthread_mutex_unlock(&s_expl_mtx);
+ /* Cell buffers (Cell layout in term.h) */
+ static RenderMode s_mode = RENDER_FULL;
+ static RenderBackend s_backend = RENDER_NCURSES;
+ static bool s_interp = false;
+ static Cell* s_cur  = NULL;   /* frame being composed */
+ static Cell* s_prev = NULL;   /* what the pad holds (RENDER_DIFF) */
+ static Cell* s_base = NULL;   /* static layer, rebuilt on resize */
+ static int s_cw = 0, s_ch = 0;
+ 
+ static inline uint32_t fx_rand(void) {   /* xorshift32, looks only */
+     uint32_t x = s_fx_semente;
+     x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+     return s_fx_semente = x;
  }
- static void expl_update(void) {
-     pthread_mutex_lock(&s_expl_mtx);
-     for (int i = 0; i < s_expl_count; ++i) {
-         s_expl[i].frames_left--;
-         if (s_expl[i].frames_left <= 0) {
-             for (int j = i; j < s_expl_count - 1; ++j) s_expl[j] = s_expl[j+1];
-             s_expl_count--;
-             i--;
-         }
+ 
+ /* A burst plus debris thrown up and out, falling back under PART_GRAVIDADE */
+ void render_add_explosion(int x, int y) {
+     static const signed char DIR[8][2] = {
+         { -2, -1 }, { -1, -2 }, { 0, -2 }, { 1, -2 }, { 2, -1 }, { -2, 0 }, { 2, 0 }, { 0, -1 },
+     };
+     part_emitir(&s_fx, PART_EXPLOSAO, x, y, 0, 0, EXPL_FRAMES, '*');
+     for (int k = 0; k < DETRITOS; k++) {
+         const uint32_t r = fx_rand();
+         const signed char* d = DIR[r & 7];
+         const int v = PART_UM / 4 + (int)((r >> 3) & 63);   /* 1/4..1/2 cell per frame and unit */
+         part_emitir(&s_fx, PART_DETRITO, x, y, d[0] * v, d[1] * v, 6 + (int)((r >> 9) % 5),
+                     ",.'`"[(r >> 12) & 3]);
      }
-     pthread_mutex_unlock(&s_expl_mtx);
  }
  
- void render_add_explosion(int x, int y) { expl_add(x, y); }
+ static void fx_rastro(int x, int y) {
+     ParticulaId* r = &s_rastro[y * s_cw + x];
+     if (part_viva(&s_fx, *r)) part_renovar(&s_fx, *r, RASTRO_FRAMES);
+     else *r = part_emitir(&s_fx, PART_RASTRO, x, y, 0, 0, RASTRO_FRAMES, '.');
+ }
+ 
+ void render_set_mode(RenderMode mode) { s_mode = mode; }
+ void render_set_backend(RenderBackend b) { s_backend = b; }
+ void render_set_interp(bool on) { s_interp = on; }
+ 
+ /* Cell of a snapshot entity, or (--interp) the cell its fixed-point
+    motion has reached by `now`, ahead of the last simulation step */
+ static inline void entity_cell(const int32_t* ox, const int32_t* oy, const int32_t* vx,
+                                const int32_t* vy, const int64_t* t0, int i, int64_t now,
+                                int* x, int* y) {
+     if (!s_interp || now <= t0[i]) return;
+     *x = fx_celula(ox[i], vx[i], now - t0[i]);
+     *y = fx_celula(oy[i], vy[i], now - t0[i]);
+ }
  
  void render_init(void) {
      initscr();
      set_escdelay(25);
      if (has_colors()) {
          start_color();
-         init_pair(CP_SHIP,      COLOR_RED,    COLOR_BLACK);
-         init_pair(CP_ROCKET,    COLOR_YELLOW, COLOR_BLACK);
-         init_pair(CP_BATTERY,   COLOR_CYAN,   COLOR_BLACK);
-         init_pair(CP_HUD,       COLOR_WHITE,  COLOR_BLACK);
-         init_pair(CP_EXPLOSION, COLOR_MAGENTA,COLOR_BLACK);
-         init_pair(CP_GROUND,    COLOR_GREEN,  COLOR_BLACK);
-         init_pair(CP_DIRECTION, COLOR_BLUE,   COLOR_BLACK);
-         init_pair(CP_TRAIL,     COLOR_YELLOW, COLOR_BLACK);
+         for (int cp = 1; cp < NUM_PARES; cp++) init_pair(cp, PAR_FG[cp], COLOR_BLACK);
      }
      cbreak();
      noecho();
@@ -79,131 +128,359 @@
      s_pad = NULL;
      s_pad_w = s_pad_h = 0;
  
-     s_expl_count = 0;
+     /* ANSI: let ncurses clear the screen now, so stdscr is clean and its
+        implicit refresh in getch() has nothing to paint over our frames */
+     if (s_backend == RENDER_ANSI) {
+         refresh();
+         term_init(has_colors() ? PAR_FG : NULL, NUM_PARES);
+     }
+ 
+     part_init(&s_fx, FX_CAP);   /* on failure effects are just dropped */
+ }
+ 
+ /* ---------- Cell canvas ---------- */
+ 
+ static inline void cv_put(int y, int x, char c, int cp) {
+     if (x >= 0 && x < s_cw && y >= 0 && y < s_ch) s_cur[y * s_cw + x] = CELL(c, cp);
+ }
+ 
+ /* Writes text, clipped at the right edge; returns the column after it */
+ static int cv_text(int y, int x, int cp, const char* s) {
+     for (; *s; s++, x++) cv_put(y, x, *s, cp);
+     return x;
+ }
+ 
+ /* ---------- HUD ----------
+  * The two HUD rows live in the static layer. compose_base lays them out
+  * once per resize (labels, bar frames) and every frame hud_linha only
+  * rewrites the fields whose value changed, formatted by hand. A field
+  * whose text changes width shifts the rest of its line, which is then
+  * rewritten as well; the result is cell for cell what the old printf
+  * layout produced. */
+ 
+ enum { HUD_LIT, HUD_INT, HUD_STR };
+ #define HUD_MAX_PECAS 14
+ 
+ typedef struct {
+     char tipo;
+     signed char largura;   /* minimum width; negative = left aligned (%-Nd) */
+     const char* txt;       /* HUD_LIT, HUD_STR */
+     int v;                 /* HUD_INT: value to show */
+     int v_desenhado;       /* what the cells hold */
+     int x, n;              /* where it was drawn; x < 0 = not yet */
+ } HudPeca;
+ 
+ typedef struct {
+     int y, x0, limite;     /* row, first column, clip column (exclusive) */
+     int n, fim;            /* pieces; column after the last one drawn */
+     HudPeca p[HUD_MAX_PECAS];
+ } HudLinha;
+ 
+ static HudLinha s_hud_topo, s_hud_lanc, s_hud_acc, s_hud_info;
+ static bool s_hud_lanc_on = false;
+ static int s_bar_lanc_x, s_bar_lanc_w, s_bar_acc_x, s_bar_acc_w;
+ static int s_bar_lanc_cheio, s_bar_acc_cheio;   /* filled cells drawn, -1 = none */
+ static const char* s_hud_nome = "";
+ 
+ /* Decimal digits of v into buf (no terminator); returns the length */
+ static int fmt_int(char* buf, int v) {
+     char d[12];
+     int n = 0, k = 0;
+     unsigned u = (v < 0) ? 0u - (unsigned)v : (unsigned)v;
+     do { d[n++] = (char)('0' + u % 10); u /= 10; } while (u);
+     if (v < 0) buf[k++] = '-';
+     while (n) buf[k++] = d[--n];
+     return k;
+ }
+ 
+ static void linha_init(HudLinha* l, int y, int x0, int limite) {
+     l->y = y; l->x0 = x0; l->limite = limite;
+     l->n = 0; l->fim = x0;
  }
  
- static void ensure_pad(int h, int w) {
-     if (!s_pad || h != s_pad_h || w != s_pad_w) {
+ static void linha_peca(HudLinha* l, char tipo, int largura, const char* txt) {
+     l->p[l->n++] = (HudPeca){ .tipo = tipo, .largura = (signed char)largura, .txt = txt, .x = -1 };
+ }
+ 
+ /* Values of the HUD_INT pieces, in order */
+ static void linha_valores(HudLinha* l, const int* v, int n) {
+     for (int i = 0, k = 0; i < l->n && k < n; i++)
+         if (l->p[i].tipo == HUD_INT) l->p[i].v = v[k++];
+ }
+ 
+ /* Text of a piece padded to its width; returns the length */
+ static int peca_texto(const HudPeca* p, char* buf) {
+     char num[12];
+     const char* s = p->txt;
+     int n;
+     if (p->tipo == HUD_INT) { n = fmt_int(num, p->v); s = num; }
+     else n = (int)strlen(s);
+     if (n > 32) n = 32;
+     const int w = (p->largura < 0) ? -p->largura : p->largura;
+     const int pad = (n < w) ? w - n : 0;
+     int k = 0;
+     if (p->largura > 0) for (int i = 0; i < pad; i++) buf[k++] = ' ';
+     memcpy(buf + k, s, (size_t)n); k += n;
+     if (p->largura < 0) for (int i = 0; i < pad; i++) buf[k++] = ' ';
+     return k;
+ }
+ 
+ static inline void base_put(const HudLinha* l, int x, Cell c) {
+     if (x >= 0 && x < l->limite && x < s_cw) s_base[l->y * s_cw + x] = c;
+ }
+ 
+ /* Rewrites the pieces that changed or moved */
+ static void hud_linha(HudLinha* l) {
+     char buf[48];
+     int x = l->x0;
+     for (int i = 0; i < l->n; i++) {
+         HudPeca* p = &l->p[i];
+         bool mudou = p->x != x || (p->tipo == HUD_INT && p->v != p->v_desenhado);
+         if (!mudou) { x += p->n; continue; }
+         const int n = peca_texto(p, buf);
+         for (int k = 0; k < n; k++) base_put(l, x + k, CELL(buf[k], CP_HUD));
+         p->x = x; p->n = n; p->v_desenhado = p->v;
+         x += n;
+     }
+     for (int k = x; k < l->fim; k++) base_put(l, k, CELL_BLANK);   /* line got shorter */
+     l->fim = x;
+ }
+ 
+ static void hud_bar(int y, int x, int w, int cheio, int* desenhado) {
+     if (cheio == *desenhado) return;
+     for (int i = 0; i < w && x + i < s_cw; i++)
+         s_base[y * s_cw + x + i] = CELL((i < cheio) ? '=' : ' ', CP_HUD);
+     *desenhado = cheio;
+ }
+ 
+ /* HUD layout for width sw: static labels into the base, fields pending */
+ static void compose_hud(int sw) {
+     /* Row 0: counters, then the rockets bar over their tail if it fits */
+     const int bar_x = 58, bar_w = (sw > 60) ? (sw / 5) : 12;
+     s_hud_lanc_on = bar_x + 10 < sw && bar_x + 2 + bar_w + 8 < sw;
+     HudLinha* l = &s_hud_topo;
+     linha_init(l, 0, 0, s_hud_lanc_on ? bar_x : sw);
+     linha_peca(l, HUD_LIT, 0, "Score:");            linha_peca(l, HUD_INT, -6, NULL);
+     linha_peca(l, HUD_LIT, 0, "  Diff:");           linha_peca(l, HUD_STR, -6, s_hud_nome);
+     linha_peca(l, HUD_LIT, 0, "  Time:");           linha_peca(l, HUD_INT, 3, NULL);
+     linha_peca(l, HUD_LIT, 0, "s  Ships Rem:");     linha_peca(l, HUD_INT, -3, NULL);
+     linha_peca(l, HUD_LIT, 0, " (spawned:");        linha_peca(l, HUD_INT, 0, NULL);
+     linha_peca(l, HUD_LIT, 0, "/");                 linha_peca(l, HUD_INT, 0, NULL);
+     linha_peca(l, HUD_LIT, 0, ")");
+ 
+     Cell* cur = s_cur;
+     s_cur = s_base;
+     if (s_hud_lanc_on) {
+         s_bar_lanc_x = cv_text(0, bar_x, CP_HUD, "Rockets:[");
+         s_bar_lanc_w = bar_w;
+         l = &s_hud_lanc;
+         linha_init(l, 0, s_bar_lanc_x + bar_w, sw);
+         linha_peca(l, HUD_LIT, 0, "] ");  linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, "/");   linha_peca(l, HUD_INT, 0, NULL);
+     }
+ 
+     /* Row 1: accuracy bar, then the tallies (short form when narrow) */
+     s_bar_acc_w = (sw > 40) ? (sw / 4) : 18;
+     s_bar_acc_x = cv_text(1, 0, CP_HUD, "Acc:[");
+     s_cur = cur;
+     l = &s_hud_acc;
+     linha_init(l, 1, s_bar_acc_x + s_bar_acc_w, sw);
+     linha_peca(l, HUD_LIT, 0, "] ");  linha_peca(l, HUD_INT, 3, NULL);  linha_peca(l, HUD_LIT, 0, "%");
+ 
+     const int info_x = 10 + s_bar_acc_w;
+     l = &s_hud_info;
+     linha_init(l, 1, info_x, sw);
+     if (info_x + 30 < sw) {
+         linha_peca(l, HUD_LIT, 0, "Hits:");       linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, " Shots:");     linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, "  Streak:");   linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, "  Kills:");    linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, " Ground:");    linha_peca(l, HUD_INT, 0, NULL);
+     } else {
+         linha_peca(l, HUD_LIT, 0, "H:");     linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, " S:");    linha_peca(l, HUD_INT, 0, NULL);
+         linha_peca(l, HUD_LIT, 0, " Stk:");  linha_peca(l, HUD_INT, 0, NULL);
+     }
+     s_bar_lanc_cheio = s_bar_acc_cheio = -1;
+ }
+ 
+ /* Static layer: ground, controls line and HUD labels (depend only on the size) */
+ static void compose_base(int sw, int sh, int ground_y) {
+     Cell* cur = s_cur;
+     s_cur = s_base;
+     for (int i = 0; i < s_cw * s_ch; i++) s_base[i] = CELL_BLANK;
+     for (int x = 0; x < sw; x++) cv_put(ground_y, x, '_', CP_GROUND);
+     cv_text(sh - 1, 0, CP_HUD, "A/D=Move | W/Q/E/Z/C=Dir | SPACE=Fire | P=Prof | X=Quit");
+     s_cur = cur;
+     compose_hud(sw);
+ }
+ 
+ static bool ensure_pad(int h, int w) {
+     if (!s_cw || h != s_pad_h || w != s_pad_w) {
          if (s_pad) { delwin(s_pad); s_pad = NULL; }
-         s_pad = newpad(h, w);
+         bool ok = (s_backend == RENDER_ANSI) ? term_resize(w, h) : (s_pad = newpad(h, w)) != NULL;
          s_pad_h = h; s_pad_w = w;
+ 
+         size_t n = (size_t)h * (size_t)w;
+         free(s_cur); free(s_prev); free(s_base); free(s_rastro);
+         s_cur  = (Cell*)malloc(sizeof(Cell) * n);
+         s_prev = (Cell*)malloc(sizeof(Cell) * n);
+         s_base = (Cell*)malloc(sizeof(Cell) * n);
+         s_rastro = (ParticulaId*)calloc(n, sizeof(ParticulaId));   /* all PART_NENHUMA */
+         s_cw = w; s_ch = h;
+         if (!ok || !s_cur || !s_prev || !s_base || !s_rastro) { s_cw = s_ch = 0; return false; }
+         for (size_t i = 0; i < n; i++) s_prev[i] = CELL_UNKNOWN;
+         return true;   /* caller rebuilds the static layer */
      }
+     return false;
  }
  
- void render_game(GameState* game) {
-     /* Snapshot world under entity locks BEFORE touching ncurses */
-     /* Ships snapshot */
-     int ship_count = 0;
-     int ship_x[MAX_NAVES], ship_y[MAX_NAVES];
- 
-     pthread_mutex_lock(&game->mutex_naves);
-     for (int i = 0; i < MAX_NAVES; i++) {
-         if (game->naves[i].ativa) {
-             ship_x[ship_count] = game->naves[i].x;
-             ship_y[ship_count] = game->naves[i].y;
-             ship_count++;
+ static inline void emit_cell(int y, int x, Cell c) {
+     wattrset(s_pad, CELL_CP(c) ? COLOR_PAIR(CELL_CP(c)) : A_NORMAL);
+     mvwaddch(s_pad, y, x, (chtype)(unsigned char)CELL_CH(c));
+ }
+ 
+ static void emit_frame(void) {
+     const int n = s_cw * s_ch;
+     if (s_mode == RENDER_DIFF) {
+         for (int i = 0; i < n; i++) {
+             if (s_cur[i] != s_prev[i]) {
+                 emit_cell(i / s_cw, i % s_cw, s_cur[i]);
+                 s_prev[i] = s_cur[i];
+             }
          }
+     } else {
+         werase(s_pad);
+         for (int i = 0; i < n; i++)
+             if (s_cur[i] != CELL_BLANK) emit_cell(i / s_cw, i % s_cw, s_cur[i]);
      }
-     pthread_mutex_unlock(&game->mutex_naves);
- 
-     /* Rockets snapshot */
-     int rocket_count = 0;
-     int rocket_x[MAX_FOGUETES], rocket_y[MAX_FOGUETES];
-     DirecaoDisparo rocket_dir[MAX_FOGUETES];
- 
-     pthread_mutex_lock(&game->mutex_foguetes);
-     for (int i = 0; i < MAX_FOGUETES; i++) {
-         if (game->foguetes[i].ativa) {
-             rocket_x[rocket_count] = game->foguetes[i].x;
-             rocket_y[rocket_count] = game->foguetes[i].y;
-             rocket_dir[rocket_count] = game->foguetes[i].direcao;
-             rocket_count++;
-         }
+     wattrset(s_pad, A_NORMAL);
+ }
+ 
+ /* Refreshes the HUD fields in the static layer from the frame's values */
+ static void render_hud(const WorldSnapshot* snap) {
+     const int destroyed = snap->naves_destruidas, reached = snap->naves_chegaram;
+     const int total = snap->naves_total, shots = snap->shots_fired, hits = snap->shots_hit;
+     int remaining = total - (destroyed + reached);
+     if (remaining < 0) remaining = 0;
+     const int topo[] = { snap->pontuacao, snap->elapsed_sec, remaining, snap->naves_spawned, total };
+     linha_valores(&s_hud_topo, topo, 5);
+     hud_linha(&s_hud_topo);
+ 
+     if (s_hud_lanc_on) {
+         const int loaded = snap->lancadores_carregados, launchers = snap->num_lancadores;
+         const int lanc[] = { loaded, launchers };
+         hud_bar(0, s_bar_lanc_x, s_bar_lanc_w,
+                 (launchers > 0) ? (loaded * s_bar_lanc_w) / launchers : 0, &s_bar_lanc_cheio);
+         linha_valores(&s_hud_lanc, lanc, 2);
+         hud_linha(&s_hud_lanc);
      }
-     pthread_mutex_unlock(&game->mutex_foguetes);
  
-     /* HUD/game metrics snapshot */
-     int sw, sh, hud, ch, bx;
-     DirecaoDisparo dir;
+     /* Same rounding as "%3.0f" and the same truncation for the bar */
+     const double acc = (shots > 0) ? (100.0 * hits / shots) : 0.0;
+     int cheio = (int)((acc / 100.0) * s_bar_acc_w);
+     if (cheio < 0) cheio = 0;
+     if (cheio > s_bar_acc_w) cheio = s_bar_acc_w;
+     hud_bar(1, s_bar_acc_x, s_bar_acc_w, cheio, &s_bar_acc_cheio);
+     const int pct = (int)nearbyint(acc);
+     linha_valores(&s_hud_acc, &pct, 1);
+     hud_linha(&s_hud_acc);
+ 
+     const int info[] = { hits, shots, snap->current_streak, destroyed, reached };
+     linha_valores(&s_hud_info, info, 5);
+     hud_linha(&s_hud_info);
+ }
  
-     pthread_mutex_lock(&game->mutex_estado);
-     sw = game->screen_width;
-     sh = game->screen_height;
-     hud = game->hud_height;
-     ch  = game->controls_height;
-     bx  = game->bateria_x;
-     dir = game->direcao_atual;
-     pthread_mutex_unlock(&game->mutex_estado);
+ void render_game(GameState* game) {
+     /* Newest published frame; the renderer never takes a simulation lock */
+     uint64_t t_prof = prof_inicio();
+     const WorldSnapshot* snap = snapshot_acquire(game->snap_render);
+     if (!snap) return;
+     prof_fim(PROF_FASE_SNAP, t_prof);
+ 
+     const int ship_count = snap->num_naves;
+     const int* ship_x = snap->nave_x;
+     const int* ship_y = snap->nave_y;
+     const int rocket_count = snap->num_foguetes;
+     const int* rocket_x  = snap->foguete_x;
+     const int* rocket_y  = snap->foguete_y;
+ 
+     int sw = snap->sw, sh = snap->sh, hud = snap->hud, ch = snap->ch;
+     int bx = snap->bateria_x;
+     DirecaoDisparo dir = snap->direcao;
  
      /* ----- Serialize all ncurses access ----- */
-     pthread_mutex_lock(&game->mutex_render);
+     LOCK(game, render);
  
      int real_h, real_w;
      getmaxyx(stdscr, real_h, real_w);
+     const int vis_h = real_h, vis_w = real_w;
      if (real_h < 8) real_h = 8;
      if (real_w < 40) real_w = 40;
  
-     ensure_pad(real_h, real_w);
-     werase(s_pad);
+     bool resized = ensure_pad(real_h, real_w);
+     if (!s_cw) { UNLOCK(game, render); return; }
  
-     /* If terminal changed, publish to game state */
+     /* If terminal changed, ask the simulation to adopt it; draw at the real size meanwhile */
      if (real_w != sw || real_h != sh) {
-         pthread_mutex_lock(&game->mutex_estado);
-         game->screen_width  = real_w;
-         game->screen_height = real_h;
-         sw = real_w; sh = real_h; hud = game->hud_height; ch = game->controls_height;
-         if (game->bateria_x >= sw) game->bateria_x = sw - 1;
-         bx = game->bateria_x;
-         pthread_mutex_unlock(&game->mutex_estado);
+         game_request_resize(game, real_w, real_h);
+         sw = real_w; sh = real_h;
+         if (bx >= sw) bx = sw - 1;
      }
  
      const int game_start_y = hud;
      const int game_end_y   = sh - ch;
      const int ground_y     = game_end_y - 1;
  
-     /* Ground line */
-     wattron(s_pad, COLOR_PAIR(CP_GROUND));
-     for (int x = 0; x < sw; x++) mvwaddch(s_pad, ground_y, x, '_');
-     wattroff(s_pad, COLOR_PAIR(CP_GROUND));
+     t_prof = prof_inicio();
+ 
+     /* Static layer (ground, controls, HUD) with this frame's HUD fields */
+     if (resized || game->cfg.name != s_hud_nome) {
+         s_hud_nome = game->cfg.name;
+         compose_base(sw, sh, ground_y);
+     }
+     render_hud(snap);
+     memcpy(s_cur, s_base, sizeof(Cell) * (size_t)(s_cw * s_ch));
+ 
+     const int64_t now = s_interp ? game_now_ms(game) : 0;
  
      /* Ships */
-     wattron(s_pad, COLOR_PAIR(CP_SHIP));
      for (int i = 0; i < ship_count; i++) {
          int x = ship_x[i], y = ship_y[i];
+         entity_cell(snap->nave_ox, snap->nave_oy, snap->nave_vx, snap->nave_vy, snap->nave_t0,
+                     i, now, &x, &y);
          if (x >= 0 && x < sw && y >= game_start_y && y < game_end_y)
-             mvwaddch(s_pad, y, x, 'V');
+             cv_put(y, x, 'V', CP_SHIP);
      }
-     wattroff(s_pad, COLOR_PAIR(CP_SHIP));
  
      /* Rockets */
-     wattron(s_pad, COLOR_PAIR(CP_ROCKET));
      for (int i = 0; i < rocket_count; i++) {
          int x = rocket_x[i], y = rocket_y[i];
+         entity_cell(snap->foguete_ox, snap->foguete_oy, snap->foguete_vx, snap->foguete_vy,
+                     snap->foguete_t0, i, now, &x, &y);
+         const int32_t vx = snap->foguete_vx[i], vy = snap->foguete_vy[i];
          char sym = '|';
-         switch (rocket_dir[i]) {
-             case DIR_VERTICAL: sym = '|'; break;
-             case DIR_DIAGONAL_ESQ: sym = '\\'; break;
-             case DIR_DIAGONAL_DIR: sym = '/'; break;
-             case DIR_HORIZONTAL_ESQ: sym = '<'; break;
-             case DIR_HORIZONTAL_DIR: sym = '>'; break;
-         }
+         if (vy == 0)      sym = (vx < 0) ? '<' : '>';
+         else if (vx < 0)  sym = '\\';
+         else if (vx > 0)  sym = '/';
          if (x >= 0 && x < sw && y >= game_start_y && y < game_end_y)
-             mvwaddch(s_pad, y, x, sym);
+             cv_put(y, x, sym, CP_ROCKET);
+ 
+         /* Trail on the cell it came from */
+         const int tx = x - (vx > 0) + (vx < 0), ty = y - (vy > 0) + (vy < 0);
+         if (tx >= 0 && tx < sw && ty >= game_start_y && ty < game_end_y) fx_rastro(tx, ty);
      }
-     wattroff(s_pad, COLOR_PAIR(CP_ROCKET));
  
      /* Battery */
-     wattron(s_pad, COLOR_PAIR(CP_BATTERY));
      if (bx >= 0 && bx < sw) {
          if (bx > 0 && bx < sw - 1) {
-             mvwaddch(s_pad, ground_y, bx - 1, '/');
-             mvwaddch(s_pad, ground_y, bx,     '^');
-             mvwaddch(s_pad, ground_y, bx + 1, '\\');
+             cv_put(ground_y, bx - 1, '/',  CP_BATTERY);
+             cv_put(ground_y, bx,     '^',  CP_BATTERY);
+             cv_put(ground_y, bx + 1, '\\', CP_BATTERY);
          } else {
-             mvwaddch(s_pad, ground_y, bx, '^');
+             cv_put(ground_y, bx, '^', CP_BATTERY);
          }
      }
-     wattroff(s_pad, COLOR_PAIR(CP_BATTERY));
  
      /* Direction indicator */
      int aim_dx = 0, aim_dy = -1; char aim_ch = '|';
@@ -214,108 +491,68 @@
          case DIR_HORIZONTAL_ESQ:  aim_dx=-1; aim_dy=0;  aim_ch='<'; break;
          case DIR_HORIZONTAL_DIR:  aim_dx=1;  aim_dy=0;  aim_ch='>'; break;
      }
-     wattron(s_pad, COLOR_PAIR(CP_DIRECTION));
      int px = bx, py = ground_y;
      for (int i = 0; i < 4; i++) {
          px += aim_dx; py += aim_dy;
          if (px >= 0 && px < sw && py >= game_start_y && py < game_end_y)
-             mvwaddch(s_pad, py, px, aim_ch);
-     }
-     wattroff(s_pad, COLOR_PAIR(CP_DIRECTION));
- 
-     /* Explosions */
-     wattron(s_pad, COLOR_PAIR(CP_TRAIL));
-     pthread_mutex_lock(&s_expl_mtx);
-     for (int i = 0; i < s_expl_count; i++) {
-         int ex = s_expl[i].x, ey = s_expl[i].y;
-         if (ex >= 0 && ex < sw && ey >= game_start_y && ey < game_end_y) {
-             mvwaddch(s_pad, ey, ex, '*');
-             if (ex > 0)               mvwaddch(s_pad, ey, ex - 1, '*');
-             if (ex < sw - 1)          mvwaddch(s_pad, ey, ex + 1, '*');
-             if (ey > game_start_y)    mvwaddch(s_pad, ey - 1, ex, '*');
-             if (ey < game_end_y - 1)  mvwaddch(s_pad, ey + 1, ex, '*');
-         }
-     }
-     pthread_mutex_unlock(&s_expl_mtx);
-     wattroff(s_pad, COLOR_PAIR(CP_TRAIL));
- 
-     /* HUD snapshot */
-     int score, destroyed, total, reached, elapsed, shots, hits, streak, spawned;
-     const char* diff_name = game->cfg.name;
-     pthread_mutex_lock(&game->mutex_estado);
-     score = game->pontuacao;
-     destroyed = game->naves_destruidas;
-     total = game->naves_total;
-     reached = game->naves_chegaram;
-     spawned = game->naves_spawned;
-     elapsed = game->elapsed_sec;
-     shots = game->shots_fired;
-     hits  = game->shots_hit;
-     streak = game->current_streak;
-     pthread_mutex_unlock(&game->mutex_estado);
- 
-     /* HUD */
-     wattron(s_pad, COLOR_PAIR(CP_HUD));
-     int handled = destroyed + reached;
-     int remaining = total - handled;
-     if (remaining < 0) remaining = 0;
-     mvwprintw(s_pad, 0, 0, "Score:%-6d  Diff:%-6s  Time:%3ds  Ships Rem:%-3d (spawned:%d/%d)",
-               score, diff_name, elapsed, remaining, spawned, total);
- 
-     /* Rockets bar */
-     int loaded = 0, launchers = 0;
-     pthread_mutex_lock(&game->mutex_lancadores);
-     launchers = game->num_lancadores;
-     for (int i = 0; i < launchers; i++)
-         if (game->lancadores[i].tem_foguete) loaded++;
-     pthread_mutex_unlock(&game->mutex_lancadores);
- 
-     int bar_x = 58;
-     int bar_w = (sw > 60) ? (sw / 5) : 12;
-     if (bar_x + 10 < sw) {
-         if (bar_x + 2 + bar_w + 8 < sw) {
-             mvwprintw(s_pad, 0, bar_x, "Rockets:[");
-             int filled = (launchers > 0) ? (loaded * bar_w) / launchers : 0;
-             for (int i = 0; i < bar_w; i++) waddch(s_pad, (i < filled) ? '=' : ' ');
-             wprintw(s_pad, "] %d/%d", loaded, launchers);
-         }
+             cv_put(py, px, aim_ch, CP_DIRECTION);
      }
  
-     /* Line 2: Accuracy + Streak + Summary */
-     double acc = (shots > 0) ? (100.0 * hits / shots) : 0.0;
-     int acc_bar_x = 0;
-     int acc_bar_w = (sw > 40) ? (sw / 4) : 18;
-     mvwprintw(s_pad, 1, acc_bar_x, "Acc:[");
-     int acc_filled = (int)((acc / 100.0) * acc_bar_w);
-     if (acc_filled < 0) acc_filled = 0;
-     if (acc_filled > acc_bar_w) acc_filled = acc_bar_w;
-     for (int i = 0; i < acc_bar_w; i++) waddch(s_pad, (i < acc_filled) ? '=' : ' ');
-     wprintw(s_pad, "] %3.0f%%", acc);
- 
-     int info_x = acc_bar_x + 10 + acc_bar_w;
-     if (info_x + 30 < sw) {
-         mvwprintw(s_pad, 1, info_x, "Hits:%d Shots:%d  Streak:%d  Kills:%d Ground:%d",
-                   hits, shots, streak, destroyed, reached);
-     } else {
-         mvwprintw(s_pad, 1, info_x, "H:%d S:%d Stk:%d", hits, shots, streak);
+     /* Effects: bursts and debris over everything, trails only on cells
+        nothing else was drawn on this frame */
+     PART_FOR_EACH(&s_fx, i) {
+         const int ex = part_cx(&s_fx, i), ey = part_cy(&s_fx, i);
+         if (ex < 0 || ex >= sw || ey < game_start_y || ey >= game_end_y) continue;
+         switch (s_fx.tipo[i]) {
+             case PART_EXPLOSAO:
+                 cv_put(ey, ex, '*', CP_EXPLOSION);
+                 if (ex > 0)               cv_put(ey, ex - 1, '*', CP_EXPLOSION);
+                 if (ex < sw - 1)          cv_put(ey, ex + 1, '*', CP_EXPLOSION);
+                 if (ey > game_start_y)    cv_put(ey - 1, ex, '*', CP_EXPLOSION);
+                 if (ey < game_end_y - 1)  cv_put(ey + 1, ex, '*', CP_EXPLOSION);
+                 break;
+             case PART_DETRITO:
+                 cv_put(ey, ex, s_fx.glifo[i], CP_EXPLOSION);
+                 break;
+             case PART_RASTRO:
+                 if (s_cur[ey * s_cw + ex] == s_base[ey * s_cw + ex])
+                     cv_put(ey, ex, s_fx.glifo[i], CP_TRAIL);
+                 break;
+         }
      }
  
-     mvwprintw(s_pad, sh - 1, 0,
-               "A/D=Move | W/Q/E/Z/C=Dir | SPACE=Fire | X=Quit");
-     wattroff(s_pad, COLOR_PAIR(CP_HUD));
+     /* Profiler overlay on the spare HUD row */
+     if (prof_on() && hud > 2) cv_text(2, 0, CP_HUD, prof_overlay());
  
-     /* Explosions decay */
-     expl_update();
+     /* Effects age */
+     part_avancar(&s_fx);
+     prof_fim(PROF_FASE_DRAW, t_prof);
  
      /* Present frame without flicker */
-     pnoutrefresh(s_pad, 0, 0, 0, 0, sh - 1, sw - 1);
-     doupdate();
+     t_prof = prof_inicio();
+     if (s_backend == RENDER_ANSI) {
+         /* ncurses repaints stdscr after a resize; take that first, then resend */
+         if (is_wintouched(stdscr)) { refresh(); term_invalidate(); }
+         term_present(s_cur, vis_w, vis_h);
+     } else {
+         emit_frame();
+         pnoutrefresh(s_pad, 0, 0, 0, 0, sh - 1, sw - 1);
+         doupdate();
+     }
+     prof_fim(PROF_FASE_UPDATE, t_prof);
  
-     pthread_mutex_unlock(&game->mutex_render);
+     UNLOCK(game, render);
  }
  
  void render_cleanup(void) {
      if (s_pad) { delwin(s_pad); s_pad = NULL; }
+     if (s_backend == RENDER_ANSI) term_cleanup();
+     free(s_cur);  s_cur  = NULL;
+     free(s_prev); s_prev = NULL;
+     free(s_base); s_base = NULL;
+     s_cw = s_ch = 0;
+     free(s_rastro); s_rastro = NULL;
+     part_free(&s_fx);
      endwin();
  }
  
\ No newline at end of file
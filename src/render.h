@@ -3,11 +3,31 @@
 
 #include "game.h"
 
+/* How a composed frame reaches the terminal */
+typedef enum {
+    RENDER_FULL,    /* erase and redraw every cell each frame */
+    RENDER_DIFF     /* write only changed cells to the pad (fewer waddch; doupdate diffs the output either way) */
+} RenderMode;
+
+void render_set_mode(RenderMode mode);   /* call before render_init */
+
+/* Who writes to the terminal */
+typedef enum {
+    RENDER_NCURSES,   /* ncurses pad + doupdate() (default) */
+    RENDER_ANSI       /* own cell diff, escape sequences, one write() per frame */
+} RenderBackend;
+
+void render_set_backend(RenderBackend b);   /* call before render_init */
+
+/* Draw entities at the cell their 16.16 origin and velocity give for the
+   frame time, instead of where the last step or tick left them */
+void render_set_interp(bool on);
 void render_init(void);
 void render_game(GameState* game);
 void render_cleanup(void);
 
-/* thread-safe, internal sync */
+/* Renderer thread only: fed by game_drenar_eventos in thread_principal.
+   A burst plus debris from the particle pool (dropped when it is full) */
 void render_add_explosion(int x, int y);
 
 #endif /* RENDER_H */
@@ -0,0 +1,203 @@
+/**
+ * replay.c - Binary session recording and playback (see replay.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "replay.h"
+#include "input.h"
+#include "config.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char MAGIC[4] = { 'A', 'I', 'R', 'P' };
+
+/* ========= Varints ========= */
+
+static int varint_put(unsigned char* p, uint64_t v) {
+    int n = 0;
+    while (v >= 0x80) { p[n++] = (unsigned char)(v | 0x80); v >>= 7; }
+    p[n++] = (unsigned char)v;
+    return n;
+}
+
+/* false on EOF or an overlong encoding */
+static bool varint_get(FILE* f, uint64_t* v) {
+    uint64_t r = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int c = fgetc(f);
+        if (c == EOF) return false;
+        r |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) { *v = r; return true; }
+    }
+    return false;
+}
+
+/* ========= Recording ========= */
+
+int replay_gravar_abrir(ReplayWriter* w, const char* path, const GameState* game) {
+    memset(w, 0, sizeof(*w));
+    w->f = fopen(path, "wb");
+    if (!w->f) { fprintf(stderr, "Cannot create replay %s\n", path); return -1; }
+    setvbuf(w->f, NULL, _IOFBF, 1 << 16);
+    if (events_init(&w->fila, REPLAY_FILA) != 0) { fclose(w->f); return -1; }
+    pthread_mutex_init(&w->escrita, NULL);
+    atomic_init(&w->perdidos, 0);
+
+    const DifficultyConfig* c = &game->cfg;
+    const uint64_t campos[] = {
+        REPLAY_VERSAO, game->semente, (uint64_t)game->tick_ms,
+        (uint64_t)game->cap_naves, (uint64_t)game->cap_foguetes,
+        (uint64_t)c->id, (uint64_t)c->launchers, (uint64_t)c->reload_ms,
+        (uint64_t)c->ships_total, (uint64_t)c->ship_speed_ms,
+        (uint64_t)c->spawn_min_ms, (uint64_t)c->spawn_max_ms, (uint64_t)game->varrido,
+        (uint64_t)c->formacao_max, (uint64_t)c->enxame,
+    };
+    unsigned char hdr[4 + 16 * 10 + 24];
+    memcpy(hdr, MAGIC, 4);
+    int n = 4;
+    for (size_t i = 0; i < sizeof campos / sizeof campos[0]; i++) n += varint_put(hdr + n, campos[i]);
+    size_t len = strnlen(c->name, 23);
+    n += varint_put(hdr + n, len);
+    memcpy(hdr + n, c->name, len);
+    n += (int)len;
+    fwrite(hdr, 1, (size_t)n, w->f);
+    w->ultimo_ms = 0;
+    return 0;
+}
+
+static void registrar(GameState* game, int tipo, int y) {
+    ReplayWriter* w = game->gravador;
+    if (!w) return;
+    Evento ev = { tipo, (int)(game_now_ms(game) - game->start_ms), y };
+    if (events_push(&w->fila, ev)) return;
+    /* Full ring. Headless, the producer is the thread that drains, so it
+       writes the backlog out itself and nothing is lost. Interactive, the
+       producer is the input thread, which must never wait on the disk:
+       count the record as dropped and let replay_gravar_fechar report it. */
+    if (game->relogio_virtual) {
+        do replay_drenar(w); while (!events_push(&w->fila, ev));
+    } else {
+        atomic_fetch_add_explicit(&w->perdidos, 1, memory_order_relaxed);
+    }
+}
+
+void replay_tecla(GameState* game, int key) {
+    if (key >= 0) registrar(game, REC_TECLA, key);
+}
+
+void replay_resize(GameState* game, int w, int h) {
+    registrar(game, REC_RESIZE, (w << 16) | (h & 0xFFFF));
+}
+
+void replay_drenar(ReplayWriter* w) {
+    Evento ev;
+    pthread_mutex_lock(&w->escrita);
+    while (events_pop(&w->fila, &ev)) {
+        unsigned char rec[4 * 10];
+        /* producers stamp before pushing, so two threads can land a ms out
+           of order: keep deltas non-negative */
+        int64_t dt = ev.x - w->ultimo_ms;
+        if (dt < 0) dt = 0;
+        w->ultimo_ms += dt;
+        int n = varint_put(rec, (uint64_t)dt);
+        if (ev.tipo == REC_TECLA) {
+            n += varint_put(rec + n, (uint64_t)ev.y << 1);
+        } else {
+            n += varint_put(rec + n, 1);
+            n += varint_put(rec + n, (uint64_t)((unsigned)ev.y >> 16));
+            n += varint_put(rec + n, (uint64_t)(ev.y & 0xFFFF));
+        }
+        fwrite(rec, 1, (size_t)n, w->f);
+    }
+    pthread_mutex_unlock(&w->escrita);
+}
+
+void replay_gravar_fechar(ReplayWriter* w) {
+    if (!w->f) return;
+    replay_drenar(w);
+    long perdidos = atomic_load(&w->perdidos);
+    if (perdidos > 0)
+        fprintf(stderr, "replay: %ld input records dropped (ring full), playback will diverge\n", perdidos);
+    fclose(w->f);
+    w->f = NULL;
+    events_free(&w->fila);
+    pthread_mutex_destroy(&w->escrita);
+}
+
+/* ========= Playback ========= */
+
+static void ler_registro(ReplayReader* r) {
+    uint64_t dt, code, w = 0, h = 0;
+    r->pendente = varint_get(r->f, &dt) && varint_get(r->f, &code) &&
+                  (code != 1 || (varint_get(r->f, &w) && varint_get(r->f, &h)));
+    if (!r->pendente) return;
+    r->prox_ms += (int64_t)dt;
+    r->code = (int)code;
+    r->w = (int)w;
+    r->h = (int)h;
+}
+
+int replay_abrir(ReplayReader* r, const char* path, GameOptions* opts) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (!r->f) { fprintf(stderr, "Cannot open replay %s\n", path); return -1; }
+
+    char magic[4];
+    uint64_t v[16] = { 0 };   /* v[12] swept, v[13..14] waves, v[15] name_len */
+    bool ok = fread(magic, 1, 4, r->f) == 4 && memcmp(magic, MAGIC, 4) == 0 &&
+              varint_get(r->f, &v[0]) && v[0] == REPLAY_VERSAO;
+    for (int i = 1; ok && i < 16; i++) ok = varint_get(r->f, &v[i]);
+    ok = ok && v[15] < sizeof r->nome && fread(r->nome, 1, (size_t)v[15], r->f) == v[15];
+    if (!ok) {
+        fprintf(stderr, "%s: not a replay (or unsupported version)\n", path);
+        fclose(r->f); r->f = NULL;
+        return -1;
+    }
+    r->nome[v[15]] = '\0';
+
+    /* The header is untrusted: range-check it before anything is sized or
+       divided by it */
+    const char* erro = NULL;
+    for (int i = 2; !erro && i < 15; i++)
+        if (v[i] > INT_MAX) erro = "header value out of range";
+    if (!erro && (v[2] < 1 || v[2] > 60000)) erro = "tick_ms";
+    if (!erro && (v[3] < 1 || v[3] > POOL_LIMIT || v[4] < 1 || v[4] > POOL_LIMIT)) erro = "pool capacity";
+    if (!erro) {
+        r->cfg = (DifficultyConfig){ (int)v[5], r->nome, (int)v[6], (int)v[7], (int)v[8],
+                                     (int)v[9], (int)v[10], (int)v[11], 0, 0, (int)v[13], (int)v[14] };
+        erro = config_validar(&r->cfg);
+    }
+    if (erro) {
+        fprintf(stderr, "%s: corrupt replay header (%s)\n", path, erro);
+        fclose(r->f); r->f = NULL;
+        return -1;
+    }
+
+    opts->seed         = v[1];
+    opts->tick_ms      = (int)v[2];
+    opts->max_naves    = (int)v[3];
+    opts->max_foguetes = (int)v[4];
+    opts->perfil       = &r->cfg;
+    opts->dificuldade  = r->cfg.id;
+    opts->ships        = 0;        /* already in the profile */
+    opts->spawn_ms     = 0;
+    opts->headless     = true;
+    opts->varrido      = v[12] != 0;
+
+    ler_registro(r);
+    return 0;
+}
+
+void replay_feed(ReplayReader* r, GameState* game, int64_t now) {
+    while (r->pendente && game->start_ms + r->prox_ms <= now) {
+        if (r->code == 1) game_resize(game, r->w, r->h);
+        else process_input(game, r->code >> 1);
+        ler_registro(r);
+    }
+}
+
+void replay_fechar(ReplayReader* r) {
+    if (r->f) fclose(r->f);
+    r->f = NULL;
+}
@@ -0,0 +1,87 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+/**
+ * replay.h - Session recording (--record) and headless playback (--replay)
+ *
+ * Stream layout, every integer an unsigned LEB128 varint:
+ *
+ *     header:  "AIRP" version seed tick_ms cap_naves cap_foguetes
+ *              profile: id launchers reload_ms ships_total ship_speed_ms
+ *                       spawn_min_ms spawn_max_ms swept formacao_max enxame
+ *                       name_len name
+ *     record:  dt_ms code [w h]
+ *
+ * dt_ms is the gap to the previous record; code is key << 1 for a key fed
+ * to process_input, or 1 for a terminal resize (followed by w and h).
+ * The profile is the effective DifficultyConfig, so a session recorded
+ * with a --config profile replays without the config file; swept is 1 for
+ * --swept. Version 4 added the wave fields along with the spawn timeline
+ * (waves.h); version 5 squeezes waves wider than the field instead of
+ * clamping them to the edge. Earlier files would not reproduce and are
+ * refused. The header gets the
+ * ranges a --config profile gets (config_validar) and pool caps are held
+ * to POOL_LIMIT, so a corrupt file is refused too. Times are game ms since
+ * game_init. The stream is append-only, so a file
+ * cut short by a crash is still a valid, shorter session.
+ *
+ * Records go through an MPSC event ring (the same one gameplay events
+ * use) and the owner of the main loop drains them into a buffered FILE,
+ * so the input thread never touches the disk. The ring holds
+ * REPLAY_FILA records, minutes of key repeat between two frames; if a
+ * stalled main loop still lets it fill, interactive producers drop the
+ * record and replay_gravar_fechar reports how many went missing.
+ * Headless, the producer is the draining thread and writes the backlog
+ * out itself, so nothing is lost. Playback feeds the records to the
+ * headless engine at their timestamps. Headless sessions reproduce
+ * exactly; interactive ones get the same seed and inputs at the same
+ * times, so they match up to scheduling jitter (input lands on a tick
+ * boundary, about one tick with --tick).
+ */
+
+#include "game.h"
+#include "events.h"
+#include <stdio.h>
+
+#define REPLAY_VERSAO 5
+#define REPLAY_FILA   16384   /* recording ring, records */
+
+typedef enum {
+    REC_TECLA,      /* x = t_ms, y = key */
+    REC_RESIZE      /* x = t_ms, y = (w << 16) | h */
+} ReplayTipo;
+
+typedef struct ReplayWriter {
+    FILE* f;
+    EventRing fila;           /* any thread -> replay_drenar */
+    pthread_mutex_t escrita;  /* serialises replay_drenar: the ring has one consumer */
+    int64_t ultimo_ms;        /* time of the last record written */
+    _Atomic long perdidos;    /* records dropped on a full ring (interactive only) */
+} ReplayWriter;
+
+typedef struct {
+    FILE* f;
+    int64_t prox_ms;          /* time of the pending record */
+    int code, w, h;
+    bool pendente;
+    DifficultyConfig cfg;     /* recorded profile, handed to game_init */
+    char nome[24];
+} ReplayReader;
+
+/* Recording. Open after game_init and before any thread starts (the seed
+   written is game->semente, which the replay's game_init lays the same
+   timeline out from). */
+int  replay_gravar_abrir(ReplayWriter* w, const char* path, const GameState* game);
+void replay_tecla(GameState* game, int key);          /* no-op unless recording */
+void replay_resize(GameState* game, int w, int h);    /* idem */
+void replay_drenar(ReplayWriter* w);                  /* any thread, serialised */
+void replay_gravar_fechar(ReplayWriter* w);           /* drains, flushes, closes */
+
+/* Playback: replay_abrir reads the header into *opts (run with headless;
+   opts->perfil points into *r, so r must outlive game_init);
+   replay_feed applies every record due by `now`. */
+int  replay_abrir(ReplayReader* r, const char* path, GameOptions* opts);
+void replay_feed(ReplayReader* r, GameState* game, int64_t now);
+void replay_fechar(ReplayReader* r);
+
+#endif /* REPLAY_H */
@@ -0,0 +1,149 @@
+/**
+ * snapshot.c - Triple-buffered world snapshots (see snapshot.h)
+ */
+#include "snapshot.h"
+#include "prof.h"
+#include <stdlib.h>
+#include <string.h>
+
+int snapshot_alloc(WorldSnapshot* s, int cap_naves, int cap_foguetes) {
+    memset(s, 0, sizeof(*s));
+    size_t per   = (size_t)6 * cap_naves + (size_t)6 * cap_foguetes;   /* int and int32_t */
+    size_t per64 = (size_t)cap_naves + (size_t)cap_foguetes;
+    int64_t* cols64 = (int64_t*)malloc(sizeof(int64_t) * per64 + sizeof(int32_t) * per);
+    if (!cols64) return -1;
+    s->mem = cols64;
+    int32_t* cols = (int32_t*)(cols64 + per64);
+    s->nave_t0    = cols64;            cols64 += cap_naves;
+    s->foguete_t0 = cols64;            cols64 += cap_foguetes;
+    s->nave_x     = cols;              cols += cap_naves;
+    s->nave_y     = cols;              cols += cap_naves;
+    s->nave_ox    = cols;              cols += cap_naves;
+    s->nave_oy    = cols;              cols += cap_naves;
+    s->nave_vx    = cols;              cols += cap_naves;
+    s->nave_vy    = cols;              cols += cap_naves;
+    s->foguete_x  = cols;              cols += cap_foguetes;
+    s->foguete_y  = cols;              cols += cap_foguetes;
+    s->foguete_ox = cols;              cols += cap_foguetes;
+    s->foguete_oy = cols;              cols += cap_foguetes;
+    s->foguete_vx = cols;              cols += cap_foguetes;
+    s->foguete_vy = cols;              cols += cap_foguetes;
+    return 0;
+}
+
+void snapshot_release(WorldSnapshot* s) {
+    free(s->mem);
+    s->mem = NULL;
+}
+
+int snapshot_init(SnapChannel* sc, int cap_naves, int cap_foguetes) {
+    memset(sc, 0, sizeof(*sc));
+    for (int i = 0; i < 3; i++) {
+        if (snapshot_alloc(&sc->buf[i], cap_naves, cap_foguetes) != 0) {
+            while (i-- > 0) snapshot_release(&sc->buf[i]);
+            return -1;
+        }
+    }
+    sc->back  = 0;
+    sc->front = 1;
+    atomic_init(&sc->ready, 2u);   /* not fresh: nothing published yet */
+    return 0;
+}
+
+void snapshot_free(SnapChannel* sc) {
+    for (int i = 0; i < 3; i++) snapshot_release(&sc->buf[i]);
+}
+
+void snapshot_copy(WorldSnapshot* dst, const WorldSnapshot* src) {
+    WorldSnapshot d = *src;   /* scalars; the columns stay dst's own */
+#define COPIAR_COL(col, n) (d.col = dst->col, memcpy(d.col, src->col, sizeof(*d.col) * (size_t)(n)))
+    COPIAR_COL(nave_x, src->num_naves);        COPIAR_COL(nave_y, src->num_naves);
+    COPIAR_COL(nave_ox, src->num_naves);       COPIAR_COL(nave_oy, src->num_naves);
+    COPIAR_COL(nave_vx, src->num_naves);       COPIAR_COL(nave_vy, src->num_naves);
+    COPIAR_COL(nave_t0, src->num_naves);
+    COPIAR_COL(foguete_x, src->num_foguetes);  COPIAR_COL(foguete_y, src->num_foguetes);
+    COPIAR_COL(foguete_ox, src->num_foguetes); COPIAR_COL(foguete_oy, src->num_foguetes);
+    COPIAR_COL(foguete_vx, src->num_foguetes); COPIAR_COL(foguete_vy, src->num_foguetes);
+    COPIAR_COL(foguete_t0, src->num_foguetes);
+#undef COPIAR_COL
+    d.mem = dst->mem;
+    *dst = d;
+}
+
+WorldSnapshot* snapshot_begin(SnapChannel* sc) {
+    return &sc->buf[sc->back];
+}
+
+void snapshot_commit(SnapChannel* sc) {
+    sc->buf[sc->back].seq = ++sc->seq;
+    /* Flip: hand the filled buffer over, take back whatever was ready */
+    unsigned prev = atomic_exchange_explicit(&sc->ready, sc->back | SNAP_FRESH, memory_order_acq_rel);
+    sc->back = prev & ~SNAP_FRESH;
+}
+
+void snapshot_publish(SnapChannel* sc, GameState* game) {
+    WorldSnapshot* s = snapshot_begin(sc);
+
+    LOCK(game, naves);
+    const EntityCols* cn = &game->col_naves;
+    s->num_naves = cn->num;
+    size_t n = (size_t)cn->num;
+    memcpy(s->nave_x,  cn->x,  sizeof(int) * n);
+    memcpy(s->nave_y,  cn->y,  sizeof(int) * n);
+    memcpy(s->nave_ox, cn->ox, sizeof(int32_t) * n);
+    memcpy(s->nave_oy, cn->oy, sizeof(int32_t) * n);
+    memcpy(s->nave_vx, cn->vx, sizeof(int32_t) * n);
+    memcpy(s->nave_vy, cn->vy, sizeof(int32_t) * n);
+    memcpy(s->nave_t0, cn->t0_ms, sizeof(int64_t) * n);
+    UNLOCK(game, naves);
+
+    LOCK(game, foguetes);
+    const EntityCols* cf = &game->col_foguetes;
+    s->num_foguetes = cf->num;
+    n = (size_t)cf->num;
+    memcpy(s->foguete_x,  cf->x,  sizeof(int) * n);
+    memcpy(s->foguete_y,  cf->y,  sizeof(int) * n);
+    memcpy(s->foguete_ox, cf->ox, sizeof(int32_t) * n);
+    memcpy(s->foguete_oy, cf->oy, sizeof(int32_t) * n);
+    memcpy(s->foguete_vx, cf->vx, sizeof(int32_t) * n);
+    memcpy(s->foguete_vy, cf->vy, sizeof(int32_t) * n);
+    memcpy(s->foguete_t0, cf->t0_ms, sizeof(int64_t) * n);
+    UNLOCK(game, foguetes);
+
+    Metricas m = game_metricas(game);
+    s->sw = m.w;    s->sh = m.h;
+    s->hud = m.hud; s->ch = m.ch;
+
+    LOCK(game, estado);
+    s->bateria_x = game->bateria_x;
+    s->direcao   = game->direcao_atual;
+    UNLOCK(game, estado);
+
+    s->pontuacao        = atomic_load_explicit(&game->pontuacao, memory_order_relaxed);
+    s->naves_destruidas = atomic_load_explicit(&game->naves_destruidas, memory_order_relaxed);
+    s->naves_chegaram   = atomic_load_explicit(&game->naves_chegaram, memory_order_relaxed);
+    s->naves_spawned    = atomic_load_explicit(&game->naves_spawned, memory_order_relaxed);
+    s->naves_total      = game->naves_total;
+    s->elapsed_sec      = atomic_load_explicit(&game->elapsed_sec, memory_order_relaxed);
+    s->shots_fired      = atomic_load_explicit(&game->shots_fired, memory_order_relaxed);
+    s->shots_hit        = atomic_load_explicit(&game->shots_hit, memory_order_relaxed);
+    s->current_streak   = atomic_load_explicit(&game->current_streak, memory_order_relaxed);
+
+    s->lancadores_carregados = atomic_load_explicit(&game->lancadores_carregados, memory_order_relaxed);
+    s->num_lancadores = game->num_lancadores;
+    s->t_ms = game_now_ms(game);
+    snapshot_commit(sc);
+}
+
+const WorldSnapshot* snapshot_acquire(SnapChannel* sc) {
+    if (atomic_load_explicit(&sc->ready, memory_order_relaxed) & SNAP_FRESH) {
+        unsigned prev = atomic_exchange_explicit(&sc->ready, sc->front, memory_order_acq_rel);
+        sc->front = prev & ~SNAP_FRESH;
+    }
+    return snapshot_peek(sc);
+}
+
+const WorldSnapshot* snapshot_peek(const SnapChannel* sc) {
+    const WorldSnapshot* s = &sc->buf[sc->front];
+    return (s->seq > 0) ? s : NULL;
+}
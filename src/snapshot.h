@@ -0,0 +1,96 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/**
+ * snapshot.h - Immutable per-tick world frames for lock-free readers
+ *
+ * The simulation copies positions, HUD counters and launcher state into a
+ * WorldSnapshot and publishes it through a triple buffer: the writer owns
+ * one buffer, the reader owns another, and the third sits in an atomic
+ * "ready" slot they exchange (wait-free on both sides, never torn, the
+ * reader always gets the newest complete frame). One writer, one reader
+ * per SnapChannel.
+ */
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "game.h"
+
+typedef struct {
+    uint64_t seq;                 /* publish counter, 1-based */
+    int64_t  t_ms;                /* sim clock at publish */
+
+    /* Screen metrics the frame was built for */
+    int sw, sh, hud, ch;
+
+    /* Battery */
+    int bateria_x;
+    DirecaoDisparo direcao;
+
+    /* HUD counters */
+    int pontuacao, naves_destruidas, naves_chegaram, naves_spawned, naves_total;
+    int elapsed_sec, shots_fired, shots_hit, current_streak;
+    int lancadores_carregados, num_lancadores;
+
+    /* Entities (columns sized to the pool capacities): the current cell,
+       plus the fixed-point motion (see EntityCols) for render-side
+       interpolation and rocket glyphs */
+    int  num_naves;
+    int* nave_x;
+    int* nave_y;
+    int  num_foguetes;
+    int* foguete_x;
+    int* foguete_y;
+    int32_t* nave_ox;
+    int32_t* nave_oy;
+    int32_t* nave_vx;
+    int32_t* nave_vy;
+    int64_t* nave_t0;
+    int32_t* foguete_ox;
+    int32_t* foguete_oy;
+    int32_t* foguete_vx;
+    int32_t* foguete_vy;
+    int64_t* foguete_t0;
+
+    void* mem;                    /* the column block */
+} WorldSnapshot;
+
+#define SNAP_FRESH 4u   /* flag bit in SnapChannel.ready: unseen frame */
+
+typedef struct SnapChannel {
+    WorldSnapshot buf[3];
+    unsigned back;                /* writer-owned index */
+    unsigned front;               /* reader-owned index */
+    _Atomic unsigned ready;       /* index | SNAP_FRESH */
+    uint64_t seq;
+} SnapChannel;
+
+/* A standalone frame with its own columns (decoders, delta bases) */
+int  snapshot_alloc(WorldSnapshot* s, int cap_naves, int cap_foguetes);   /* 0 on success */
+void snapshot_release(WorldSnapshot* s);
+
+/* Copies the scalars and the live part of every column; dst keeps its
+   own column storage */
+void snapshot_copy(WorldSnapshot* dst, const WorldSnapshot* src);
+
+int  snapshot_init(SnapChannel* sc, int cap_naves, int cap_foguetes);   /* 0 on success */
+void snapshot_free(SnapChannel* sc);
+
+/* Writer side: fill the back buffer from the game and flip it in.
+   Takes mutex_naves, mutex_foguetes and mutex_estado one at a time. */
+void snapshot_publish(SnapChannel* sc, GameState* game);
+
+/* Writer side, any other source: fill snapshot_begin's buffer, then
+   snapshot_commit stamps the seq and flips it in */
+WorldSnapshot* snapshot_begin(SnapChannel* sc);
+void snapshot_commit(SnapChannel* sc);
+
+/* Reader side: newest published frame, or NULL before the first publish.
+   Stays valid until the next snapshot_acquire on the same channel. */
+const WorldSnapshot* snapshot_acquire(SnapChannel* sc);
+
+/* Reader side: the frame the last snapshot_acquire returned (or NULL) */
+const WorldSnapshot* snapshot_peek(const SnapChannel* sc);
+
+#endif /* SNAPSHOT_H */
@@ -0,0 +1,657 @@
+/**
+ * spectate.c - Spectator server and viewer (see spectate.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "spectate.h"
+#include "pool.h"
+#include "render.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <ncurses.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char MAGIC[4] = { 'A', 'I', 'S', 'P' };
+
+#define QUADRO_MAX (64u << 20)   /* viewer: larger frames are a broken stream */
+
+static int64_t mono_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* ========= Byte buffers and varints ========= */
+
+/* Bytes [off, len) are pending: unsent (server) or unparsed (viewer) */
+typedef struct { unsigned char* p; size_t len, off, cap; } Buf;
+
+static bool buf_reservar(Buf* b, size_t n) {
+    if (b->off > 0 && b->len + n > b->cap) {   /* reclaim the consumed prefix first */
+        memmove(b->p, b->p + b->off, b->len - b->off);
+        b->len -= b->off;
+        b->off = 0;
+    }
+    if (b->len + n <= b->cap) return true;
+    size_t cap = b->cap ? b->cap : 4096;
+    while (cap < b->len + n) cap *= 2;
+    unsigned char* p = (unsigned char*)realloc(b->p, cap);
+    if (!p) return false;
+    b->p = p;
+    b->cap = cap;
+    return true;
+}
+
+static bool buf_anexar(Buf* b, const Buf* de) {
+    if (!buf_reservar(b, de->len)) return false;
+    memcpy(b->p + b->len, de->p, de->len);
+    b->len += de->len;
+    return true;
+}
+
+/* Unchecked: callers reserve the worst case first */
+static inline void put_v(Buf* b, uint64_t v) {
+    while (v >= 0x80) { b->p[b->len++] = (unsigned char)(v | 0x80); v >>= 7; }
+    b->p[b->len++] = (unsigned char)v;
+}
+
+static inline uint64_t zz(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+static inline int64_t unzz(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+/* false at the end of the data or on an overlong encoding */
+static bool get_v(const unsigned char** p, const unsigned char* fim, uint64_t* v) {
+    uint64_t r = 0;
+    for (int shift = 0; shift < 64 && *p < fim; shift += 7) {
+        unsigned char c = *(*p)++;
+        r |= (uint64_t)(c & 0x7F) << shift;
+        if (!(c & 0x80)) { *v = r; return true; }
+    }
+    return false;
+}
+
+static bool get_int(const unsigned char** p, const unsigned char* fim, int* v) {
+    uint64_t u;
+    if (!get_v(p, fim, &u)) return false;
+    int64_t s = unzz(u);
+    if (s < INT32_MIN || s > INT32_MAX) return false;
+    *v = (int)s;
+    return true;
+}
+
+/* ========= Frame codec ========= */
+
+#define NUM_CABECALHO 16
+#define CABECALHO(w) { &(w)->sw, &(w)->sh, &(w)->hud, &(w)->ch, &(w)->bateria_x,             \
+                       &(w)->pontuacao, &(w)->naves_destruidas, &(w)->naves_chegaram,       \
+                       &(w)->naves_spawned, &(w)->naves_total, &(w)->elapsed_sec,           \
+                       &(w)->shots_fired, &(w)->shots_hit, &(w)->current_streak,            \
+                       &(w)->lancadores_carregados, &(w)->num_lancadores }
+
+/* One entity table; vx/vy only for rockets (their heading is on the wire) */
+typedef struct {
+    int n;
+    int* x;
+    int* y;
+    int32_t* vx;
+    int32_t* vy;
+} Tabela;
+
+static Tabela naves_de(const WorldSnapshot* w) {
+    return (Tabela){ w->num_naves, w->nave_x, w->nave_y, NULL, NULL };
+}
+static Tabela foguetes_de(const WorldSnapshot* w) {
+    return (Tabela){ w->num_foguetes, w->foguete_x, w->foguete_y, w->foguete_vx, w->foguete_vy };
+}
+
+static inline int rumo(const Tabela* t, int i) {
+    int sx = (t->vx[i] > 0) - (t->vx[i] < 0);
+    int sy = (t->vy[i] > 0) - (t->vy[i] < 0);
+    return 3 * (sx + 1) + (sy + 1);
+}
+
+/* Slots past the base's count compare against (0, 0), heading 4 (still) */
+static inline bool mudou(const Tabela* t, const Tabela* b, int i) {
+    if (i >= b->n) return t->x[i] != 0 || t->y[i] != 0 || (t->vx && rumo(t, i) != 4);
+    return t->x[i] != b->x[i] || t->y[i] != b->y[i] || (t->vx && rumo(t, i) != rumo(b, i));
+}
+
+static void put_tabela(Buf* b, const Tabela* t, const Tabela* base) {
+    put_v(b, (uint64_t)t->n);
+    if (!base) {
+        for (int i = 0; i < t->n; i++) {
+            put_v(b, zz(t->x[i]));
+            put_v(b, zz(t->y[i]));
+            if (t->vx) put_v(b, (uint64_t)rumo(t, i));
+        }
+        return;
+    }
+    int m = 0;
+    for (int i = 0; i < t->n; i++) m += mudou(t, base, i);
+    put_v(b, (uint64_t)m);
+    for (int i = 0, ant = -1; i < t->n; i++) {
+        if (!mudou(t, base, i)) continue;
+        bool velho = i < base->n;
+        put_v(b, (uint64_t)(i - ant - 1));
+        put_v(b, zz((int64_t)t->x[i] - (velho ? base->x[i] : 0)));
+        put_v(b, zz((int64_t)t->y[i] - (velho ? base->y[i] : 0)));
+        if (t->vx) put_v(b, (uint64_t)rumo(t, i));
+        ant = i;
+    }
+}
+
+/* Frames `w` into `out` (len + payload): a keyframe, or a delta on `base` */
+static bool codificar(Buf* out, Buf* tmp, const WorldSnapshot* w, const WorldSnapshot* base) {
+    out->len = out->off = 0;
+    tmp->len = tmp->off = 0;
+    /* worst case: 10 bytes per header varint, 3-4 varints of 5 per entity */
+    size_t max = 10 * (NUM_CABECALHO + 8) + 15 * (size_t)w->num_naves + 20 * (size_t)w->num_foguetes;
+    if (!buf_reservar(tmp, max) || !buf_reservar(out, max + 10)) return false;
+
+    put_v(tmp, base ? 1 : 0);
+    put_v(tmp, w->seq);
+    put_v(tmp, zz(w->t_ms));
+    put_v(tmp, (uint64_t)w->direcao);
+    const int* const cab[NUM_CABECALHO] = CABECALHO(w);
+    for (int i = 0; i < NUM_CABECALHO; i++) put_v(tmp, zz(*cab[i]));
+
+    Tabela tn = naves_de(w), tf = foguetes_de(w);
+    Tabela bn, bf;
+    if (base) { bn = naves_de(base); bf = foguetes_de(base); }
+    put_tabela(tmp, &tn, base ? &bn : NULL);
+    put_tabela(tmp, &tf, base ? &bf : NULL);
+
+    put_v(out, tmp->len);
+    memcpy(out->p + out->len, tmp->p, tmp->len);
+    out->len += tmp->len;
+    return true;
+}
+
+static bool ler_tabela(const unsigned char** p, const unsigned char* fim, Tabela* t, int cap, bool chave) {
+    uint64_t n, d;
+    if (!get_v(p, fim, &n) || n > (uint64_t)cap) return false;
+    if (chave) {
+        for (int i = 0; i < (int)n; i++) {
+            if (!get_int(p, fim, &t->x[i]) || !get_int(p, fim, &t->y[i])) return false;
+            if (t->vx) {
+                if (!get_v(p, fim, &d) || d > 8) return false;
+                t->vx[i] = (int32_t)(d / 3) - 1;
+                t->vy[i] = (int32_t)(d % 3) - 1;
+            }
+        }
+    } else {
+        for (int i = t->n; i < (int)n; i++) {
+            t->x[i] = t->y[i] = 0;
+            if (t->vx) t->vx[i] = t->vy[i] = 0;
+        }
+        uint64_t m, gap;
+        if (!get_v(p, fim, &m) || m > n) return false;
+        int64_t idx = -1;
+        for (uint64_t k = 0; k < m; k++) {
+            int dx, dy;
+            if (!get_v(p, fim, &gap) || !get_int(p, fim, &dx) || !get_int(p, fim, &dy)) return false;
+            idx += (int64_t)gap + 1;
+            if (gap >= n || idx >= (int64_t)n) return false;
+            t->x[idx] += dx;
+            t->y[idx] += dy;
+            if (t->vx) {
+                if (!get_v(p, fim, &d) || d > 8) return false;
+                t->vx[idx] = (int32_t)(d / 3) - 1;
+                t->vy[idx] = (int32_t)(d % 3) - 1;
+            }
+        }
+    }
+    t->n = (int)n;
+    return true;
+}
+
+/* Applies the next complete frame in `b` to `w`: 1 applied, 0 incomplete,
+   -1 malformed */
+static int decodificar(Buf* b, WorldSnapshot* w, int cap_naves, int cap_foguetes, bool* tem_chave) {
+    const unsigned char* p = b->p + b->off;
+    const unsigned char* fim = b->p + b->len;
+    uint64_t len, kind, seq, t_ms, dir;
+    if (!get_v(&p, fim, &len)) return (fim - (b->p + b->off) >= 10) ? -1 : 0;
+    if (len > QUADRO_MAX) return -1;
+    if ((uint64_t)(fim - p) < len) return 0;
+    fim = p + len;
+
+    if (!get_v(&p, fim, &kind) || kind > 1 || !get_v(&p, fim, &seq) ||
+        !get_v(&p, fim, &t_ms) || !get_v(&p, fim, &dir) || dir > DIR_HORIZONTAL_DIR) return -1;
+    if (kind == 1 && !*tem_chave) return -1;   /* a delta needs a base */
+    int* const cab[NUM_CABECALHO] = CABECALHO(w);
+    for (int i = 0; i < NUM_CABECALHO; i++)
+        if (!get_int(&p, fim, cab[i])) return -1;
+    w->seq = seq;
+    w->t_ms = unzz(t_ms);
+    w->direcao = (DirecaoDisparo)dir;
+
+    Tabela tn = naves_de(w), tf = foguetes_de(w);
+    if (!ler_tabela(&p, fim, &tn, cap_naves, kind == 0) ||
+        !ler_tabela(&p, fim, &tf, cap_foguetes, kind == 0) || p != fim) return -1;
+    w->num_naves = tn.n;
+    w->num_foguetes = tf.n;
+    *tem_chave = true;
+
+    b->off = (size_t)(fim - b->p);
+    if (b->off == b->len) b->off = b->len = 0;
+    return 1;
+}
+
+/* ========= Server ========= */
+
+/* epoll data.u64: slot in the low word, its generation (never 0) in the
+   high one, so an event queued for a connection that has since been
+   closed is not applied to the next one in the same slot */
+#define ID_ESCUTA 0xFFFFFFFFu
+#define ID_EVENTO 0xFFFFFFFEu
+
+typedef struct {
+    int fd;                   /* -1: free slot */
+    Buf saida;                /* unsent bytes */
+    bool sincronizado;        /* holds every frame since its last keyframe */
+    bool quer_saida;          /* EPOLLOUT registered */
+    int64_t progresso_ms;     /* last time the backlog shrank or started */
+    uint32_t geracao;         /* bumped per connection; survives cliente_fechar */
+} Cliente;
+
+struct SpectServer {
+    SnapChannel canal;        /* renderer -> server thread */
+    WorldSnapshot base;       /* last frame encoded: the delta base */
+    bool tem_base;
+    Buf hello, chave, delta, tmp;
+    int lfd, epfd, evfd;
+    pthread_t thread;
+    bool thread_ativa;
+    atomic_bool parar;
+    atomic_int conectados;    /* renderer skips the copy when 0 */
+    Cliente cli[SPECT_MAX_CLIENTES];
+};
+
+static inline uint64_t cliente_id(const SpectServer* s, int i) {
+    return ((uint64_t)s->cli[i].geracao << 32) | (uint32_t)i;
+}
+
+static void cliente_fechar(SpectServer* s, int i) {
+    Cliente* c = &s->cli[i];
+    const uint32_t geracao = c->geracao;
+    epoll_ctl(s->epfd, EPOLL_CTL_DEL, c->fd, NULL);
+    close(c->fd);
+    free(c->saida.p);
+    memset(c, 0, sizeof(*c));
+    c->fd = -1;
+    c->geracao = geracao;
+    atomic_fetch_sub_explicit(&s->conectados, 1, memory_order_relaxed);
+}
+
+static void cliente_enviar(SpectServer* s, int i) {
+    Cliente* c = &s->cli[i];
+    while (c->saida.off < c->saida.len) {
+        ssize_t k = send(c->fd, c->saida.p + c->saida.off, c->saida.len - c->saida.off, MSG_NOSIGNAL);
+        if (k > 0) { c->saida.off += (size_t)k; c->progresso_ms = mono_ms(); continue; }
+        if (k < 0 && errno == EINTR) continue;
+        if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        cliente_fechar(s, i);
+        return;
+    }
+    if (c->saida.off == c->saida.len) c->saida.off = c->saida.len = 0;
+
+    bool quer = c->saida.len > 0;
+    if (quer != c->quer_saida) {
+        struct epoll_event ev = { .events = EPOLLIN | (quer ? EPOLLOUT : 0), .data.u64 = cliente_id(s, i) };
+        epoll_ctl(s->epfd, EPOLL_CTL_MOD, c->fd, &ev);
+        c->quer_saida = quer;
+    }
+}
+
+static bool cliente_anexar(Cliente* c, const Buf* quadro) {
+    if (c->saida.len == c->saida.off) c->progresso_ms = mono_ms();
+    return buf_anexar(&c->saida, quadro);
+}
+
+static void aceitar(SpectServer* s) {
+    for (;;) {
+        int fd = accept(s->lfd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;   /* EAGAIN: backlog empty (or out of fds: retried on the next event) */
+        }
+        int i = 0;
+        while (i < SPECT_MAX_CLIENTES && s->cli[i].fd >= 0) i++;
+        if (i == SPECT_MAX_CLIENTES) { close(fd); continue; }
+
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+        int um = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof um);
+        Cliente* c = &s->cli[i];
+        const uint32_t geracao = (c->geracao + 1) ? c->geracao + 1 : 1;
+        struct epoll_event ev = { .events = EPOLLIN, .data.u64 = ((uint64_t)geracao << 32) | (uint32_t)i };
+        if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, fd, &ev) != 0) { close(fd); continue; }
+
+        memset(c, 0, sizeof(*c));
+        c->fd = fd;
+        c->geracao = geracao;
+        atomic_fetch_add_explicit(&s->conectados, 1, memory_order_relaxed);
+        if (!cliente_anexar(c, &s->hello)) { cliente_fechar(s, i); continue; }
+        cliente_enviar(s, i);
+    }
+}
+
+/* Spectators only watch: input is read and discarded, EOF disconnects.
+   Events for an earlier connection in the slot are stale and ignored. */
+static void atender(SpectServer* s, uint64_t id, uint32_t eventos) {
+    const int i = (int)(uint32_t)id;
+    Cliente* c = &s->cli[i];
+    if (c->fd < 0 || cliente_id(s, i) != id) return;
+    if (eventos & (EPOLLERR | EPOLLHUP)) { cliente_fechar(s, i); return; }
+    if (eventos & EPOLLIN) {
+        char lixo[512];
+        for (;;) {
+            ssize_t k = recv(c->fd, lixo, sizeof lixo, 0);
+            if (k > 0) continue;
+            if (k < 0 && errno == EINTR) continue;
+            if (k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            cliente_fechar(s, i);
+            return;
+        }
+    }
+    if (eventos & EPOLLOUT) cliente_enviar(s, i);
+}
+
+/* Encodes the newest frame once (a delta, plus a keyframe only if someone
+   needs one) and queues it for every client that can take it */
+static void novo_quadro(SpectServer* s) {
+    const WorldSnapshot* w = snapshot_acquire(&s->canal);
+    if (!w || (s->tem_base && w->seq == s->base.seq)) return;
+
+    bool tem_delta = s->tem_base && codificar(&s->delta, &s->tmp, w, &s->base);
+    bool tem_chave = false;
+    for (int i = 0; i < SPECT_MAX_CLIENTES; i++) {
+        Cliente* c = &s->cli[i];
+        if (c->fd < 0) continue;
+        size_t pendente = c->saida.len - c->saida.off;
+        if (c->sincronizado) {
+            /* A delta the link can't absorb is skipped, and so is every frame
+               after it until the backlog drains and a keyframe resyncs */
+            if (!tem_delta || pendente + s->delta.len > SPECT_BACKLOG) { c->sincronizado = false; continue; }
+            if (!cliente_anexar(c, &s->delta)) { cliente_fechar(s, i); continue; }
+        } else if (pendente == 0) {
+            if (!tem_chave && !(tem_chave = codificar(&s->chave, &s->tmp, w, NULL))) continue;
+            if (!cliente_anexar(c, &s->chave)) { cliente_fechar(s, i); continue; }
+            c->sincronizado = true;
+        } else {
+            continue;
+        }
+        cliente_enviar(s, i);
+    }
+    snapshot_copy(&s->base, w);
+    s->tem_base = true;
+}
+
+static void expirar(SpectServer* s, int64_t agora) {
+    for (int i = 0; i < SPECT_MAX_CLIENTES; i++) {
+        Cliente* c = &s->cli[i];
+        if (c->fd >= 0 && c->saida.len > c->saida.off && agora - c->progresso_ms > SPECT_TIMEOUT_MS)
+            cliente_fechar(s, i);
+    }
+}
+
+static void* spect_thread(void* arg) {
+    SpectServer* s = (SpectServer*)arg;
+    struct epoll_event evs[32];
+    while (!atomic_load(&s->parar)) {
+        /* Sleep until something happens; wake once a second only while
+           some backlog is pending, to enforce SPECT_TIMEOUT_MS */
+        int espera = -1;
+        for (int i = 0; i < SPECT_MAX_CLIENTES; i++)
+            if (s->cli[i].fd >= 0 && s->cli[i].saida.len > s->cli[i].saida.off) { espera = 1000; break; }
+
+        int n = epoll_wait(s->epfd, evs, 32, espera);
+        if (n < 0 && errno != EINTR) break;
+        for (int k = 0; k < n; k++) {
+            uint64_t id = evs[k].data.u64;
+            if (id == ID_ESCUTA) {
+                aceitar(s);
+            } else if (id == ID_EVENTO) {
+                uint64_t v;
+                if (read(s->evfd, &v, sizeof v) < 0) { /* spurious: nothing to coalesce */ }
+                novo_quadro(s);
+            } else {
+                atender(s, id, evs[k].events);
+            }
+        }
+        if (espera >= 0) expirar(s, mono_ms());
+    }
+    return NULL;
+}
+
+static void spect_liberar(SpectServer* s) {
+    for (int i = 0; i < SPECT_MAX_CLIENTES; i++)
+        if (s->cli[i].fd >= 0) cliente_fechar(s, i);
+    if (s->lfd >= 0)  close(s->lfd);
+    if (s->epfd >= 0) close(s->epfd);
+    if (s->evfd >= 0) close(s->evfd);
+    free(s->hello.p); free(s->chave.p); free(s->delta.p); free(s->tmp.p);
+    snapshot_release(&s->base);
+    snapshot_free(&s->canal);
+    free(s);
+}
+
+SpectServer* spect_iniciar(int porta, const GameState* game) {
+    SpectServer* s = (SpectServer*)calloc(1, sizeof(SpectServer));
+    if (!s) return NULL;
+    s->lfd = s->epfd = s->evfd = -1;
+    for (int i = 0; i < SPECT_MAX_CLIENTES; i++) s->cli[i].fd = -1;
+    atomic_init(&s->parar, false);
+    atomic_init(&s->conectados, 0);
+
+    bool ok = snapshot_init(&s->canal, game->cap_naves, game->cap_foguetes) == 0;
+    ok = ok && snapshot_alloc(&s->base, game->cap_naves, game->cap_foguetes) == 0;
+
+    size_t nome_len = strnlen(game->cfg.name, 23);
+    ok = ok && buf_reservar(&s->hello, 4 + 4 * 10 + nome_len);
+    if (ok) {
+        memcpy(s->hello.p, MAGIC, 4);
+        s->hello.len = 4;
+        put_v(&s->hello, SPECT_VERSAO);
+        put_v(&s->hello, (uint64_t)game->cap_naves);
+        put_v(&s->hello, (uint64_t)game->cap_foguetes);
+        put_v(&s->hello, nome_len);
+        memcpy(s->hello.p + s->hello.len, game->cfg.name, nome_len);
+        s->hello.len += nome_len;
+    }
+    if (!ok) { fprintf(stderr, "Failed to allocate spectator buffers\n"); spect_liberar(s); return NULL; }
+
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons((uint16_t)porta),
+                                .sin_addr.s_addr = htonl(INADDR_ANY) };
+    int um = 1;
+    s->lfd = socket(AF_INET, SOCK_STREAM, 0);
+    if (s->lfd < 0 || setsockopt(s->lfd, SOL_SOCKET, SO_REUSEADDR, &um, sizeof um) != 0 ||
+        bind(s->lfd, (struct sockaddr*)&addr, sizeof addr) != 0 || listen(s->lfd, 16) != 0) {
+        fprintf(stderr, "Cannot listen on port %d: %s\n", porta, strerror(errno));
+        spect_liberar(s);
+        return NULL;
+    }
+    fcntl(s->lfd, F_SETFL, O_NONBLOCK);
+
+    s->evfd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    s->epfd = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event ev_l = { .events = EPOLLIN, .data.u64 = ID_ESCUTA };
+    struct epoll_event ev_e = { .events = EPOLLIN, .data.u64 = ID_EVENTO };
+    if (s->evfd < 0 || s->epfd < 0 ||
+        epoll_ctl(s->epfd, EPOLL_CTL_ADD, s->lfd, &ev_l) != 0 ||
+        epoll_ctl(s->epfd, EPOLL_CTL_ADD, s->evfd, &ev_e) != 0 ||
+        thread_criar(&s->thread, spect_thread, s) != 0) {
+        fprintf(stderr, "Failed to start spectator server\n");
+        spect_liberar(s);
+        return NULL;
+    }
+    s->thread_ativa = true;
+    return s;
+}
+
+void spect_publicar(SpectServer* s, const WorldSnapshot* snap) {
+    if (!snap || atomic_load_explicit(&s->conectados, memory_order_relaxed) == 0) return;
+    snapshot_copy(snapshot_begin(&s->canal), snap);
+    snapshot_commit(&s->canal);
+    uint64_t um = 1;
+    if (write(s->evfd, &um, sizeof um) < 0) { /* counter saturated: already pending */ }
+}
+
+void spect_parar(SpectServer* s) {
+    if (!s) return;
+    atomic_store(&s->parar, true);
+    uint64_t um = 1;
+    if (write(s->evfd, &um, sizeof um) < 0) { /* already signalled */ }
+    if (s->thread_ativa) pthread_join(s->thread, NULL);
+    spect_liberar(s);
+}
+
+/* ========= Viewer ========= */
+
+static int conectar(const char* endereco) {
+    char host[256];
+    const char* porta = strrchr(endereco, ':');
+    if (porta) {
+        size_t n = (size_t)(porta - endereco);
+        if (n >= sizeof host) return -1;
+        memcpy(host, endereco, n);
+        host[n] = '\0';
+        porta++;
+    } else {
+        porta = endereco;
+        host[0] = '\0';
+    }
+    struct addrinfo dica = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM }, *res, *a;
+    if (getaddrinfo(host[0] ? host : "localhost", porta, &dica, &res) != 0) return -1;
+    int fd = -1;
+    for (a = res; a; a = a->ai_next) {
+        fd = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+        if (fd < 0) continue;
+        if (connect(fd, a->ai_addr, a->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/* Appends whatever the socket has; false on EOF or an error */
+static bool receber(int fd, Buf* b) {
+    for (;;) {
+        if (!buf_reservar(b, 16384)) return false;
+        ssize_t k = recv(fd, b->p + b->len, b->cap - b->len, 0);
+        if (k > 0) { b->len += (size_t)k; continue; }
+        if (k < 0 && errno == EINTR) continue;
+        return k < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+}
+
+/* Hello: 1 parsed, 0 incomplete, -1 not a (supported) spectator stream */
+static int ler_hello(Buf* b, int* cap_naves, int* cap_foguetes, char* nome, size_t nome_max) {
+    const unsigned char* p = b->p + b->off;
+    const unsigned char* fim = b->p + b->len;
+    if (fim - p < 4) return 0;
+    if (memcmp(p, MAGIC, 4) != 0) return -1;
+    p += 4;
+    uint64_t v[4];
+    for (int i = 0; i < 4; i++)
+        if (!get_v(&p, fim, &v[i])) return (fim - p >= 10) ? -1 : 0;
+    if (v[0] != SPECT_VERSAO || v[1] < 1 || v[1] > POOL_LIMIT || v[2] < 1 || v[2] > POOL_LIMIT ||
+        v[3] >= nome_max) return -1;
+    if ((uint64_t)(fim - p) < v[3]) return 0;
+    memcpy(nome, p, (size_t)v[3]);
+    nome[v[3]] = '\0';
+    *cap_naves = (int)v[1];
+    *cap_foguetes = (int)v[2];
+    b->off = (size_t)(p + v[3] - b->p);
+    return 1;
+}
+
+int spect_assistir(const char* endereco, GameOptions* opts) {
+    int fd = conectar(endereco);
+    if (fd < 0) { fprintf(stderr, "Cannot connect to %s\n", endereco); return -1; }
+
+    Buf ent = { 0 };
+    char nome[24];
+    int cap_naves = 0, cap_foguetes = 0, r;
+    while ((r = ler_hello(&ent, &cap_naves, &cap_foguetes, nome, sizeof nome)) == 0) {
+        if (!buf_reservar(&ent, 256)) { r = -1; break; }
+        ssize_t k = recv(fd, ent.p + ent.len, ent.cap - ent.len, 0);
+        if (k <= 0 && !(k < 0 && errno == EINTR)) { r = -1; break; }
+        if (k > 0) ent.len += (size_t)k;
+    }
+    if (r < 0) {
+        fprintf(stderr, "%s: not a spectator stream (or unsupported version)\n", endereco);
+        close(fd); free(ent.p);
+        return -1;
+    }
+
+    /* A local game only for the renderer's channel and HUD; nothing runs */
+    opts->max_naves    = cap_naves;
+    opts->max_foguetes = cap_foguetes;
+    opts->sim_mode     = SIM_TICK;
+    opts->headless     = false;
+    GameState game;
+    WorldSnapshot est;
+    if (game_init(&game, opts) != 0) {
+        fprintf(stderr, "Failed to allocate game state\n");
+        close(fd); free(ent.p);
+        return -1;
+    }
+    if (snapshot_alloc(&est, cap_naves, cap_foguetes) != 0) {
+        fprintf(stderr, "Failed to allocate game state\n");
+        game_cleanup(&game); close(fd); free(ent.p);
+        return -1;
+    }
+    game.cfg.name = nome;
+    fcntl(fd, F_SETFL, O_NONBLOCK);
+
+    render_set_interp(false);   /* the stream carries cells, not motion */
+    render_init();
+
+    bool fim = false, tem_chave = false, erro = false;
+    while (!fim) {
+        struct pollfd pf[2] = { { fd, POLLIN, 0 }, { STDIN_FILENO, POLLIN, 0 } };
+        if (poll(pf, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        bool novo = false;
+        if (pf[0].revents) {
+            fim = !receber(fd, &ent);
+            while ((r = decodificar(&ent, &est, cap_naves, cap_foguetes, &tem_chave)) == 1) novo = true;
+            if (r < 0) { erro = fim = true; novo = false; }
+        }
+        if (pf[1].revents) {
+            int ch;
+            while ((ch = getch()) != ERR) {
+                if (ch == 'x' || ch == 'X' || ch == 'q' || ch == 'Q' || ch == 27) fim = true;
+                else if (ch == KEY_RESIZE) novo = tem_chave;
+            }
+        }
+        if (novo) {
+            snapshot_copy(snapshot_begin(game.snap_render), &est);
+            snapshot_commit(game.snap_render);
+            render_game(&game);
+        }
+    }
+
+    render_cleanup();
+    if (erro) fprintf(stderr, "%s: malformed spectator stream\n", endereco);
+    snapshot_release(&est);
+    game_cleanup(&game);
+    close(fd);
+    free(ent.p);
+    return erro ? -1 : 0;
+}
@@ -0,0 +1,59 @@
+#ifndef SPECTATE_H
+#define SPECTATE_H
+
+/**
+ * spectate.h - Live spectator stream over TCP (--serve) and its viewer (--watch)
+ *
+ * The renderer hands every frame it draws to the server through a second
+ * SnapChannel (one snapshot copy, no game locks). The server thread
+ * encodes each frame once and fans it out from an epoll loop over
+ * non-blocking sockets. Stream layout, every integer an unsigned LEB128
+ * varint:
+ *
+ *     hello:   "AISP" version cap_naves cap_foguetes name_len name
+ *     frame:   len payload
+ *     payload: kind seq t_ms direcao
+ *              sw sh hud ch bateria_x pontuacao destruidas chegaram
+ *              spawned total elapsed shots hits streak carregados lancadores
+ *              ships:   num, then K: (x y)*      D: changed (gap dx dy)*
+ *              rockets: num, then K: (x y dir)*  D: changed (gap dx dy dir)*
+ *
+ * t_ms, the sixteen fields from sw to lancadores and every x y dx dy are
+ * zigzag-coded; kind, seq, direcao, the counts, gaps and dir are plain.
+ * kind 0 is a keyframe with every entity; kind 1 is a delta against the
+ * previous frame listing only the slots whose cell or heading changed,
+ * indices gap-coded (index - previous index - 1) and coordinates as
+ * differences. Slots past the previous count are diffed against (0, 0).
+ * dir is the rocket heading, 3 * (sign vx + 1) + (sign vy + 1).
+ *
+ * A client gets a keyframe when it joins and deltas while it keeps up.
+ * One whose unsent backlog would pass SPECT_BACKLOG skips frames until
+ * it drains, then resyncs on a fresh keyframe (so slow links are
+ * downsampled, not queued); one that makes no progress for
+ * SPECT_TIMEOUT_MS is dropped. Nothing on this path ever blocks the
+ * renderer or the simulation.
+ */
+
+#include "game.h"
+#include "snapshot.h"
+
+#define SPECT_VERSAO       1
+#define SPECT_MAX_CLIENTES 64
+#define SPECT_BACKLOG      (64 * 1024)
+#define SPECT_TIMEOUT_MS   5000
+
+typedef struct SpectServer SpectServer;
+
+/* Listens on `porta` (all interfaces) and starts the server thread */
+SpectServer* spect_iniciar(int porta, const GameState* game);   /* NULL on failure */
+
+/* Renderer thread: offer the frame just drawn (copies, then one wakeup) */
+void spect_publicar(SpectServer* s, const WorldSnapshot* snap);
+
+void spect_parar(SpectServer* s);   /* disconnects everyone, joins, frees */
+
+/* --watch host:port: draws a remote session with the local renderer until
+   the stream ends or the user quits; 0 on a clean exit */
+int spect_assistir(const char* endereco, GameOptions* opts);
+
+#endif /* SPECTATE_H */
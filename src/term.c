@@ -0,0 +1,169 @@
+/**
+ * term.c - ANSI frame writer (see term.h)
+ */
+#define _POSIX_C_SOURCE 200809L
+
+#include "term.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SYNC_INICIO "\x1b[?2026h"
+#define SYNC_FIM    "\x1b[?2026l"
+
+/* Worst case per cell: CUP with two 5-digit coordinates, SGR, glyph */
+#define BYTES_POR_CELULA 24
+
+static Cell* s_front = NULL;            /* what the terminal shows */
+static int s_w = 0, s_h = 0;
+static char* s_out = NULL;              /* frame stream, sized for the worst case */
+static size_t s_len = 0;
+
+static const short* s_fg = NULL;
+static int s_pares = 0;
+
+/* Terminal state after the last byte sent; -1 = unknown */
+static int s_cx = -1, s_cy = -1, s_cp = -1;
+static bool s_limpar = true;            /* next frame starts with a clear */
+
+static inline void put(const char* s, size_t n) { memcpy(s_out + s_len, s, n); s_len += n; }
+static inline void put_c(char c) { s_out[s_len++] = c; }
+
+static void put_int(int v) {
+    char d[10];
+    int n = 0;
+    do { d[n++] = (char)('0' + v % 10); v /= 10; } while (v);
+    while (n) s_out[s_len++] = d[--n];
+}
+
+/* Absolute (CUP) or, on the same row, relative forward (CUF) move */
+static void mover(int x, int y) {
+    put("\x1b[", 2);
+    if (y == s_cy && s_cx >= 0 && x > s_cx) {
+        if (x - s_cx > 1) put_int(x - s_cx);
+        put_c('C');
+    } else {
+        if (y > 0 || x > 0) put_int(y + 1);
+        if (x > 0) { put_c(';'); put_int(x + 1); }
+        put_c('H');
+    }
+    s_cx = x; s_cy = y;
+}
+
+static void cor(int cp) {
+    if (!s_fg || cp == s_cp) return;
+    if (cp <= 0 || cp >= s_pares) {
+        put("\x1b[0m", 4);
+    } else {
+        put("\x1b[3", 3);
+        put_c((char)('0' + s_fg[cp]));
+        put(";40m", 4);
+    }
+    s_cp = cp;
+}
+
+/* A short run of unchanged cells in the current colour is cheaper to
+   resend than to skip with an escape sequence */
+static bool lacuna_barata(const Cell* row, int de, int ate) {
+    if (ate - de >= 4) return false;
+    if (!s_fg) return true;
+    for (int x = de; x < ate; x++)
+        if ((int)CELL_CP(row[x]) != s_cp) return false;
+    return true;
+}
+
+void term_init(const short* fg, int num_pares) {
+    s_fg = fg;
+    s_pares = num_pares;
+    s_cx = s_cy = s_cp = -1;
+}
+
+bool term_resize(int w, int h) {
+    size_t n = (size_t)w * (size_t)h;
+    free(s_front); free(s_out);
+    s_front = (Cell*)malloc(sizeof(Cell) * n);
+    s_out = (char*)malloc(n * BYTES_POR_CELULA + sizeof SYNC_INICIO + sizeof SYNC_FIM);
+    if (!s_front || !s_out) {
+        free(s_front); free(s_out);
+        s_front = NULL; s_out = NULL;
+        s_w = s_h = 0;
+        return false;
+    }
+    s_w = w; s_h = h;
+    term_invalidate();
+    return true;
+}
+
+/* The next frame clears the screen and then only sends non-blank cells */
+void term_invalidate(void) {
+    s_limpar = true;
+    s_cx = s_cy = s_cp = -1;
+}
+
+static void enviar(void) {
+    const char* p = s_out;
+    size_t n = s_len;
+    while (n > 0) {
+        ssize_t k = write(STDOUT_FILENO, p, n);
+        if (k < 0) {
+            if (errno == EINTR) continue;
+            term_invalidate();   /* partial frame: resend everything next time */
+            return;
+        }
+        p += k;
+        n -= (size_t)k;
+    }
+}
+
+void term_present(const Cell* cells, int vis_w, int vis_h) {
+    if (!s_front) return;
+    if (vis_w > s_w) vis_w = s_w;
+    if (vis_h > s_h) vis_h = s_h;
+
+    s_len = 0;
+    put(SYNC_INICIO, sizeof SYNC_INICIO - 1);
+    const size_t vazio = s_len;
+    if (s_limpar) {
+        put("\x1b[0m\x1b[2J", 8);
+        for (int i = 0; i < s_w * s_h; i++) s_front[i] = CELL_BLANK;
+        s_cp = 0;
+        s_limpar = false;
+    }
+
+    for (int y = 0; y < vis_h; y++) {
+        const Cell* row = cells + (size_t)y * s_w;
+        Cell* front = s_front + (size_t)y * s_w;
+        for (int x = 0; x < vis_w; x++) {
+            const Cell c = row[x];
+            if (c == front[x]) continue;
+            if (y == s_cy && s_cx >= 0 && x > s_cx && lacuna_barata(row, s_cx, x)) {
+                for (int k = s_cx; k < x; k++) put_c(CELL_CH(row[k]));
+                s_cx = x;
+            } else if (x != s_cx || y != s_cy) {
+                mover(x, y);
+            }
+            cor((int)CELL_CP(c));
+            put_c(CELL_CH(c));
+            front[x] = c;
+            /* The last column leaves the cursor in the pending-wrap state,
+               which terminals disagree on: reposition absolutely next time */
+            if (++s_cx >= vis_w) s_cx = s_cy = -1;
+        }
+    }
+    if (s_len == vazio) return;
+
+    put(SYNC_FIM, sizeof SYNC_FIM - 1);
+    enviar();
+}
+
+void term_cleanup(void) {
+    if (s_out && s_fg) {
+        s_len = 0;
+        put("\x1b[0m", 4);
+        enviar();
+    }
+    free(s_front); s_front = NULL;
+    free(s_out); s_out = NULL;
+    s_w = s_h = 0;
+}
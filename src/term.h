@@ -0,0 +1,41 @@
+#ifndef TERM_H
+#define TERM_H
+
+/**
+ * term.h - ANSI escape-sequence frame writer (--ansi render backend)
+ *
+ * Keeps its own copy of what the terminal shows and turns each composed
+ * frame into a short stream of cursor moves, SGR colour changes and
+ * glyphs for the cells that differ, sent with one write(). The stream is
+ * wrapped in synchronized output (DEC private mode 2026) so terminals that
+ * support it paint the frame atomically; terminals that don't ignore the
+ * unknown mode. A frame with no changes costs no syscall at all.
+ *
+ * ncurses stays initialised for input, terminal modes and the window size;
+ * only its output path is bypassed. Renderer thread only, under the render
+ * mutex like every other terminal access.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* Cell: low byte glyph, high byte colour pair */
+typedef uint16_t Cell;
+#define CELL(ch, cp)   ((Cell)(((cp) << 8) | (unsigned char)(ch)))
+#define CELL_CH(c)     ((char)((c) & 0xFF))
+#define CELL_CP(c)     ((c) >> 8)
+#define CELL_BLANK     CELL(' ', 0)
+#define CELL_UNKNOWN   ((Cell)0xFFFF)   /* never equal to a real cell */
+
+/* fg[cp] is the ANSI colour (0-7) of pair cp on a black background; pair 0
+   is the terminal default. fg == NULL: monochrome, no SGR at all. */
+void term_init(const short* fg, int num_pares);
+bool term_resize(int w, int h);   /* canvas size; false on allocation failure */
+void term_invalidate(void);       /* screen repainted behind our back: resend all */
+
+/* Sends the cells of `cells` (w-wide canvas) that changed, clipped to the
+   vis_w x vis_h the terminal actually has */
+void term_present(const Cell* cells, int vis_w, int vis_h);
+void term_cleanup(void);
+
+#endif /* TERM_H */
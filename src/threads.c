@@ -1,6 +1,9 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include <unistd.h>
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
 #include <stdlib.h>
 #include <time.h>
 #include <math.h>
@@ -9,296 +12,589 @@
 #include "render.h"
 #include "input.h"
 #include "game.h"
-
-/* Utility: randomized spawn interval within [min,max] ms; fixed if equal */
-static inline int next_spawn_ms(const DifficultyConfig* cfg) {
-    if (cfg->spawn_min_ms >= cfg->spawn_max_ms) return cfg->spawn_min_ms;
-    int span = cfg->spawn_max_ms - cfg->spawn_min_ms;
-    return cfg->spawn_min_ms + (rand() % (span + 1));
+#include "grid.h"
+#include "snapshot.h"
+#include "events.h"
+#include "prof.h"
+#include "replay.h"
+#include "spectate.h"
+#include "autopilot.h"
+#include "affinity.h"
+
+static inline int64_t mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
 }
 
+/* Main loop: end conditions, spawning and the render scheduler.
+ * Frames are paced on absolute CLOCK_MONOTONIC deadlines (no drift from
+ * render cost); a frame that overruns by whole periods skips them instead
+ * of queueing catch-up frames. Spawns have their own deadline, so spawn
+ * timing does not depend on the frame rate. fps == 0 renders uncapped.
+ * Sleeps are timed waits on cond_game_over, so a quit never waits out a
+ * frame period. */
 void* thread_principal(void* arg) {
     GameState* game = (GameState*)arg;
-    struct timespec last_spawn_ts;
-    clock_gettime(CLOCK_MONOTONIC, &last_spawn_ts);
-    int wait_ms = next_spawn_ms(&game->cfg);
-
-    while (!atomic_load(&game->game_over)) {
-        /* Update elapsed & check end conditions */
-        pthread_mutex_lock(&game->mutex_estado);
-        game->elapsed_sec = (int)difftime(time(NULL), game->start_time);
-
-        int total = game->naves_total;
-        int destroyed = game->naves_destruidas;
-        int reached   = game->naves_chegaram;
-        int spawned   = game->naves_spawned;
-
-        bool lose_now = (reached > (total / 2)); /* immediate defeat if > half reached */
-
-        /* Finish only when all ships handled OR defeat now */
-        bool all_handled = (destroyed + reached) >= total;
+    const int64_t frame_ns = (game->fps > 0) ? 1000000000LL / game->fps : 0;
 
-        pthread_mutex_unlock(&game->mutex_estado);
+    int64_t now = mono_ns();
+    int64_t next_frame = now;
+    int64_t next_spawn = game->start_ms;   /* the timeline says when the first ship is due */
 
-        if (lose_now || all_handled) {
-            pthread_mutex_lock(&game->mutex_estado);
-            atomic_store(&game->game_over, true);
-            pthread_cond_broadcast(&game->cond_game_over);
-            pthread_mutex_unlock(&game->mutex_estado);
-            break;
-        }
-
-        /* Spawn logic: until total ships are spawned */
-        if (spawned < total) {
-            struct timespec now;
-            clock_gettime(CLOCK_MONOTONIC, &now);
-
-            long diff_ms = (now.tv_sec - last_spawn_ts.tv_sec) * 1000L
-                         + (now.tv_nsec - last_spawn_ts.tv_nsec) / 1000000L;
-
-            if (diff_ms >= wait_ms) {
-                criar_nave(game);
-                clock_gettime(CLOCK_MONOTONIC, &last_spawn_ts);
-                wait_ms = next_spawn_ms(&game->cfg);
+    while (!atomic_load(&game->game_over)) {
+        game_drenar_eventos(game, render_add_explosion);
+        if (game->gravador) replay_drenar(game->gravador);
+        if (game_check_end(game)) break;
+
+        now = mono_ns();
+        bool spawning = game_spawn_tick(game, game_now_ms(game), &next_spawn);
+        if (game->piloto) autopilot_passo(game->piloto, game, game_now_ms(game));
+
+        if (now >= next_frame) {
+            /* Thread model has no tick: publish the frame from here */
+            if (game->sim_mode == SIM_THREADS) {
+                game_apply_resize(game);
+                snapshot_publish(game->snap_render, game);
+            }
+            render_game(game);
+            if (game->espect) spect_publicar(game->espect, snapshot_peek(game->snap_render));
+            game->frames_rendered++;
+
+            now = mono_ns();
+            if (frame_ns == 0) {
+                next_frame = now;
+            } else {
+                next_frame += frame_ns;
+                if (now - next_frame >= frame_ns) {   /* over budget: drop missed frames */
+                    int64_t missed = (now - next_frame) / frame_ns;
+                    next_frame += missed * frame_ns;
+                    game->frames_skipped += (int)missed;
+                }
             }
         }
 
-        render_game(game);
-        usleep(33000); /* ~30 FPS */
+        int64_t wake = next_frame;
+        if (spawning && next_spawn * 1000000LL < wake) wake = next_spawn * 1000000LL;
+        if (game->piloto && game->piloto->prox_ms * 1000000LL < wake) wake = game->piloto->prox_ms * 1000000LL;
+        if (wake > now) game_esperar_ns(game, wake);
     }
     return NULL;
 }
 
+/* Blocks in poll() on stdin and the wakeup pipe; mutex_render is taken
+ * only once keys are pending, and everything pending is drained, up to
+ * INPUT_BATCH keys per hold, before poll() again. */
+#define INPUT_BATCH 64
+
 void* thread_input(void* arg) {
+    PROF_THREAD_ENTER();
     GameState* game = (GameState*)arg;
-    while (!atomic_load(&game->game_over)) {
-        pthread_mutex_lock(&game->mutex_render);
-        int ch = getch();
-        pthread_mutex_unlock(&game->mutex_render);
+    afin_aplicar(AFIN_INPUT);
+    struct pollfd fds[2] = {
+        { .fd = STDIN_FILENO,     .events = POLLIN },
+        { .fd = game->wake_fd[0], .events = POLLIN },
+    };
+
+    while (!atomic_load(&game->encerrado)) {
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;   /* e.g. SIGWINCH; doupdate handles resize */
+            break;
+        }
+        if (fds[1].revents) break;          /* shutdown */
+        if (!(fds[0].revents & POLLIN)) {
+            if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) break;   /* stdin gone */
+            continue;
+        }
 
-        if (ch != ERR) process_input(game, ch);
-        usleep(2000);
+        /* Key-to-rocket latency runs from this wake-up: it includes waiting
+           for the renderer's lock and every lock on the fire path */
+        const uint64_t t_tecla = prof_inicio();
+
+        /* Drain until getch() says ERR: keys ncurses has already read into
+           its own buffer do not make stdin readable again, so stopping at a
+           full batch would leave them until the next keypress */
+        bool vazio = false;
+        while (!vazio) {
+            int keys[INPUT_BATCH], n = 0, ch = ERR;
+            LOCK(game, render);
+            while (n < INPUT_BATCH && (ch = getch()) != ERR) keys[n++] = ch;
+            UNLOCK(game, render);
+            vazio = (ch == ERR);
+
+            for (int i = 0; i < n; i++)
+                if (process_input(game, keys[i]) && t_tecla)
+                    prof_latencia(PROF_LAT_DISPARO, prof_now_ns() - t_tecla);
+        }
     }
+    PROF_THREAD_EXIT();
     return NULL;
 }
 
-void* thread_nave(void* arg) {
-    ThreadArgs* args = (ThreadArgs*)arg;
-    Nave* nave = (Nave*)args->entity;
-    GameState* game = args->game;
-
-    int velocidade_ms = game->cfg.ship_speed_ms;
-
-    while (!atomic_load(&game->game_over)) {
-        pthread_mutex_lock(&game->mutex_naves);
-        if (!nave->ativa) { pthread_mutex_unlock(&game->mutex_naves); break; }
-        nave->y++;
-        int nx = nave->x, ny = nave->y;
-        pthread_mutex_unlock(&game->mutex_naves);
+/* ========= Pooled entity steps (SIM_THREADS) =========
+ * One call is one step of one entity, run by whichever pool worker picks
+ * it up: the entity moves to its cell at the current time, and the return
+ * value is when it enters the next one (col_proxima_ms), or -1 once it is
+ * gone and its slot released. A ship step takes mutex_naves, then
+ * mutex_foguetes on its own; the rocket step the reverse, never nested. */
+
+int64_t nave_passo(void* ctx, int id) {
+    GameState* game = (GameState*)ctx;
+    EntityCols* cn = &game->col_naves;
+
+    int64_t prox = -1;
+    LOCK(game, naves);
+    if (!atomic_load(&game->game_over) && col_viva(cn, id)) {
+        int p = cn->pos[id];
+        int64_t now = game_now_ms(game);
+        bool moveu = col_avancar(cn, p, now);
+        prox = col_proxima_ms(cn, p);
+        if (prox <= now) prox = now + 1;
+        if (!moveu) { UNLOCK(game, naves); return prox; }   /* woke early */
+        int nx = cn->x[p], ny = cn->y[p];
+        grid_move(&game->grid_naves, id, nx, ny);
+        UNLOCK(game, naves);
 
         /* ground metrics */
-        int sh, ch;
-        pthread_mutex_lock(&game->mutex_estado);
-        sh = game->screen_height; ch = game->controls_height;
-        pthread_mutex_unlock(&game->mutex_estado);
+        Metricas m = game_metricas(game);
+        int sh = m.h, ch = m.ch;
 
         if (ny >= (sh - ch - 1)) {
             bool first = false;
-            pthread_mutex_lock(&game->mutex_naves);
-            if (nave->ativa) {         /* transition gate: ground reached once */
-                nave->ativa = false;
+            LOCK(game, naves);
+            if (col_viva(cn, id)) {    /* transition gate: ground reached once */
+                nave_desativar(game, id);
                 first = true;
             }
-            pthread_mutex_unlock(&game->mutex_naves);
-
-            if (first) {
-                pthread_mutex_lock(&game->mutex_estado);
-                game->naves_chegaram++;
-                game->current_streak = 0; /* break combo */
-                pthread_mutex_unlock(&game->mutex_estado);
+            UNLOCK(game, naves);
+
+            if (first) game_evento(game, EV_CHEGADA, nx, ny);
+            prox = -1;
+        } else {
+            /* collision against rockets (forgiving box, grid neighbourhood only) */
+            LOCK(game, foguetes);
+            bool colidiu = false;
+            int fi = foguete_colidindo(game, nx, ny);
+            if (fi >= 0) {
+                foguete_desativar(game, fi);
+                colidiu = true;
             }
-            break;
-        }
+            UNLOCK(game, foguetes);
+
+            if (colidiu) {
+                bool first = false;
+                LOCK(game, naves);
+                if (col_viva(cn, id)) {      /* transition gate: only one step counts the kill */
+                    nave_desativar(game, id);
+                    game->naves[id].destruida = true;
+                    first = true;
+                }
+                UNLOCK(game, naves);
 
-        /* collision against rockets (forgiving box) */
-        pthread_mutex_lock(&game->mutex_foguetes);
-        bool colidiu = false;
-        for (int i = 0; i < MAX_FOGUETES; i++) {
-            if (game->foguetes[i].ativa) {
-                int dx = abs(game->foguetes[i].x - nx);
-                int dy = abs(game->foguetes[i].y - ny);
-                if (dx <= 2 && dy <= 2) {
-                    game->foguetes[i].ativa = false;
-                    colidiu = true;
-                    break;
+                if (first) {
+                    game_evento(game, EV_ABATE, nx, ny);
                 }
+                prox = -1;
             }
         }
-        pthread_mutex_unlock(&game->mutex_foguetes);
+        if (prox >= 0) return prox;
+        LOCK(game, naves);
+    }
 
-        if (colidiu) {
-            bool first = false;
-            pthread_mutex_lock(&game->mutex_naves);
-            if (nave->ativa) {           /* transition gate: only one thread counts kill */
-                nave->ativa = false;
-                nave->destruida = true;
-                first = true;
-            }
-            pthread_mutex_unlock(&game->mutex_naves);
-
-            if (first) {
-                render_add_explosion(nx, ny);
-                pthread_mutex_lock(&game->mutex_estado);
-                game->naves_destruidas++;
-                game->pontuacao += 10;
-                game->shots_hit++;
-                game->current_streak++;
-                if (game->current_streak > game->best_streak) game->best_streak = game->current_streak;
-                pthread_mutex_unlock(&game->mutex_estado);
+    nave_liberar(game, id);   /* nothing references the slot any more */
+    UNLOCK(game, naves);
+    return -1;
+}
+
+int64_t foguete_passo(void* ctx, int id) {
+    GameState* game = (GameState*)ctx;
+    EntityCols* cf = &game->col_foguetes;
+
+    /* velocity already set by tentar_disparar from the fire direction */
+    LOCK(game, foguetes);
+    if (!atomic_load(&game->game_over) && col_viva(cf, id)) {
+        int p = cf->pos[id];
+        int64_t now = game_now_ms(game);
+        bool moveu = col_avancar(cf, p, now);
+        int64_t prox = col_proxima_ms(cf, p);
+        if (prox <= now) prox = now + 1;
+        if (!moveu) { UNLOCK(game, foguetes); return prox; }
+        int fx = cf->x[p], fy = cf->y[p];
+        grid_move(&game->grid_foguetes, id, fx, fy);
+        UNLOCK(game, foguetes);
+
+        Metricas m = game_metricas(game);
+        int sw = m.w, sh = m.h, hud = m.hud, ch = m.ch;
+
+        if (fx < 0 || fx >= sw || fy < hud || fy >= (sh - ch)) {
+            LOCK(game, foguetes);
+            foguete_desativar(game, id);
+        } else {
+            /* rocket-side collision (same forgiving box) */
+            bool hit = false; int ex = 0, ey = 0;
+
+            LOCK(game, naves);
+            int ni = nave_colidindo(game, fx, fy);
+            if (ni >= 0) {
+                /* transition gate: only count if we flip the ship out of the live set */
+                const EntityCols* cn = &game->col_naves;
+                ex = cn->x[cn->pos[ni]];
+                ey = cn->y[cn->pos[ni]];
+                nave_desativar(game, ni);
+                game->naves[ni].destruida = true;
+                hit = true;
             }
-            break;
-        }
+            UNLOCK(game, naves);
 
-        usleep(velocidade_ms * 1000);
+            if (!hit) return prox;
+            game_evento(game, EV_ABATE, ex, ey);
+            LOCK(game, foguetes);
+            foguete_desativar(game, id);
+        }
     }
 
-    pthread_mutex_lock(&game->mutex_naves);
-    game->num_naves_ativas--;
-    pthread_mutex_unlock(&game->mutex_naves);
+    foguete_liberar(game, id);
+    UNLOCK(game, foguetes);
+    return -1;
+}
+
+/* Reloader: one thread, every empty launcher reloading in parallel. Sleeps
+ * on cond_lancador_vazio until the earliest ready time (CLOCK_MONOTONIC
+ * timedwait), a new empty launcher, or shutdown (finalizar_threads
+ * broadcasts the same condition), so exit never waits out a reload. */
+void* thread_artilheiro(void* arg) {
+    PROF_THREAD_ENTER();
+    GameState* game = (GameState*)arg;
 
-    free(args);
+    LOCK(game, lancadores);
+    while (!atomic_load(&game->encerrado)) {
+        int64_t proxima;
+        recarga_vencidas(game, game_now_ms(game), &proxima);
+        if (proxima == INT64_MAX) {
+            pthread_cond_wait(&game->cond_lancador_vazio, &game->mutex_lancadores);
+        } else {
+            struct timespec ts = { .tv_sec = (time_t)(proxima / 1000), .tv_nsec = (long)(proxima % 1000) * 1000000L };
+            pthread_cond_timedwait(&game->cond_lancador_vazio, &game->mutex_lancadores, &ts);
+        }
+    }
+    UNLOCK(game, lancadores);
+    PROF_THREAD_EXIT();
     return NULL;
 }
 
-void* thread_foguete(void* arg) {
-    ThreadArgs* args = (ThreadArgs*)arg;
-    Foguete* f = (Foguete*)args->entity;
-    GameState* game = args->game;
-
-    switch (f->direcao) {
-        case DIR_VERTICAL:        f->dx = 0;  f->dy = -1; break;
-        case DIR_DIAGONAL_ESQ:    f->dx = -1; f->dy = -1; break;
-        case DIR_DIAGONAL_DIR:    f->dx = 1;  f->dy = -1; break;
-        case DIR_HORIZONTAL_ESQ:  f->dx = -1; f->dy = 0;  break;
-        case DIR_HORIZONTAL_DIR:  f->dx = 1;  f->dy = 0;  break;
-    }
 
-    while (!atomic_load(&game->game_over)) {
-        pthread_mutex_lock(&game->mutex_foguetes);
-        if (!f->ativa) { pthread_mutex_unlock(&game->mutex_foguetes); break; }
-        f->x += f->dx;
-        f->y += f->dy;
-        pthread_mutex_unlock(&game->mutex_foguetes);
-
-        int sw, sh, hud, ch;
-        pthread_mutex_lock(&game->mutex_estado);
-        sw = game->screen_width; sh = game->screen_height;
-        hud = game->hud_height;  ch = game->controls_height;
-        pthread_mutex_unlock(&game->mutex_estado);
-
-        if (f->x < 0 || f->x >= sw || f->y < hud || f->y >= (sh - ch)) {
-            pthread_mutex_lock(&game->mutex_foguetes);
-            f->ativa = false;
-            pthread_mutex_unlock(&game->mutex_foguetes);
-            break;
-        }
+/* ========= Single-loop simulation (SIM_TICK) =========
+ * One thread replaces the pooled steps. Each tick takes mutex_naves ->
+ * mutex_foguetes once and advances every entity to the tick time by v * dt
+ * in fixed point. A long tick is cut into sub-steps no longer than the
+ * fastest entity needs to cross a cell, so nothing skips a cell (and the
+ * collision test there); kills and arrivals go out as events once the
+ * locks are released.
+ * Per-cell rules are identical to the pooled versions above. */
+
+/* Kills and arrivals wait in tick_ev until sim_tick has released the
+   entity locks, since game_evento may wait on a full ring. At most one per
+   ship slot: a ship leaves once, and a freed slot is only refilled by the
+   spawner, between ticks. */
+static inline void tick_evento(GameState* game, int tipo, int x, int y) {
+    game->tick_ev[game->num_tick_ev++] = (Evento){ tipo, x, y };
+}
 
-        /* rocket-side collision (same forgiving box) */
-        int fx = f->x, fy = f->y;
-        bool hit = false; int hit_ship = -1; bool first = false;
-
-        pthread_mutex_lock(&game->mutex_naves);
-        for (int i = 0; i < MAX_NAVES; i++) {
-            if (game->naves[i].ativa) {
-                int dx = abs(game->naves[i].x - fx);
-                int dy = abs(game->naves[i].y - fy);
-                if (dx <= 2 && dy <= 2) {
-                    /* transition gate: only count if we flip ativa->false */
-                    game->naves[i].ativa = false;
-                    game->naves[i].destruida = true;
-                    first = true;
-                    hit_ship = i;
-                    hit = true;
-                    break;
-                }
-            }
-        }
-        pthread_mutex_unlock(&game->mutex_naves);
-
-        if (hit) {
-            pthread_mutex_lock(&game->mutex_foguetes);
-            f->ativa = false;
-            pthread_mutex_unlock(&game->mutex_foguetes);
-
-            if (hit_ship >= 0 && first) {
-                int ex, ey;
-                pthread_mutex_lock(&game->mutex_naves);
-                ex = game->naves[hit_ship].x;
-                ey = game->naves[hit_ship].y;
-                pthread_mutex_unlock(&game->mutex_naves);
-                render_add_explosion(ex, ey);
-            }
-            if (first) {
-                pthread_mutex_lock(&game->mutex_estado);
-                game->naves_destruidas++;
-                game->pontuacao += 10;
-                game->shots_hit++;
-                game->current_streak++;
-                if (game->current_streak > game->best_streak) game->best_streak = game->current_streak;
-                pthread_mutex_unlock(&game->mutex_estado);
-            }
-            break;
-        }
+static void tick_publicar(GameState* game) {
+    for (int i = 0; i < game->num_tick_ev; i++)
+        game_evento(game, game->tick_ev[i].tipo, game->tick_ev[i].x, game->tick_ev[i].y);
+    game->num_tick_ev = 0;
+}
 
-        usleep(35000);
+/* A ship at dense index p just entered a new cell; false once it is gone */
+static bool tick_passo_nave(GameState* game, int p, int ground_y) {
+    EntityCols* cn = &game->col_naves;
+    int id = cn->id[p];
+    int x = cn->x[p], y = cn->y[p];
+    if (y >= ground_y) {
+        nave_desativar(game, id);
+        tick_evento(game, EV_CHEGADA, x, y);
+        return false;
+    }
+    grid_move(&game->grid_naves, id, x, y);
+    int fi = foguete_colidindo(game, x, y);
+    if (fi >= 0) {
+        foguete_desativar(game, fi);
+        nave_desativar(game, id);
+        game->naves[id].destruida = true;
+        tick_evento(game, EV_ABATE, x, y);
+        return false;
     }
+    return true;
+}
 
-    pthread_mutex_lock(&game->mutex_foguetes);
-    game->num_foguetes_ativos--;
-    pthread_mutex_unlock(&game->mutex_foguetes);
+/* A rocket at dense index p just entered a new cell; false once it is gone */
+static bool tick_passo_foguete(GameState* game, int p, int sw, int sh, int hud, int ch) {
+    EntityCols* cf = &game->col_foguetes;
+    int id = cf->id[p];
+    int x = cf->x[p], y = cf->y[p];
+    if (x < 0 || x >= sw || y < hud || y >= (sh - ch)) {
+        foguete_desativar(game, id);
+        return false;
+    }
+    grid_move(&game->grid_foguetes, id, x, y);
+    int ni = nave_colidindo(game, x, y);
+    if (ni >= 0) {
+        const EntityCols* cn = &game->col_naves;
+        int ex = cn->x[cn->pos[ni]], ey = cn->y[cn->pos[ni]];
+        nave_desativar(game, ni);
+        game->naves[ni].destruida = true;
+        foguete_desativar(game, id);
+        tick_evento(game, EV_ABATE, ex, ey);
+        return false;
+    }
+    return true;
+}
 
-    free(args);
-    return NULL;
+/* ========= Swept collision (SIM_TICK --swept) =========
+ * Positions are exact functions of time (fx_celula), so a tick need not be
+ * cut into one-cell sub-steps. It is taken whole: each rocket queries the
+ * grid around its path for ships, and each pair gets the first millisecond
+ * in (sim_t_ms, now] at which their cells overlap (|dx|, |dy| <= HIT_BOX).
+ * Ships fall straight down and rockets never descend, so the gap between
+ * two cells is monotone in time along either axis and every boundary is
+ * one binary search. Hits and landings are then applied in time order,
+ * each entity taking part in at most one, and the survivors jump to `now`.
+ * Only the collision test is tick-free: each pair is resolved at its first
+ * overlapping millisecond within the tick. Spawns and input still land on
+ * tick boundaries, so a run's kills and shots do change with tick_ms.
+ * The hit list is sized at game_init and never grows under the locks: a
+ * tick that finds more is stepped the plain way instead, losing no hit. */
+
+typedef struct Impacto {
+    int64_t t;
+    int nave;
+    int foguete;          /* -1: the ship lands */
+} Impacto;
+
+typedef struct {
+    int32_t o, v;         /* 16.16 origin and velocity along one axis */
+    int64_t t0;
+} Eixo;
+
+static const Eixo EIXO_ZERO = { 0, 0, 0 };
+
+static inline Eixo eixo_x(const EntityCols* c, int p) { return (Eixo){ c->ox[p], c->vx[p], c->t0_ms[p] }; }
+static inline Eixo eixo_y(const EntityCols* c, int p) { return (Eixo){ c->oy[p], c->vy[p], c->t0_ms[p] }; }
+static inline int eixo_celula(Eixo e, int64_t t) { return fx_celula(e.o, e.v, t - e.t0); }
+
+/* First t in [lo, hi) with s * (cell a - cell b) >= alvo, that quantity
+   being non-decreasing in t; hi if there is none */
+static int64_t primeiro_ms(Eixo a, Eixo b, int s, int alvo, int64_t lo, int64_t hi) {
+    while (lo < hi) {
+        int64_t m = lo + (hi - lo) / 2;
+        if (s * (eixo_celula(a, m) - eixo_celula(b, m)) >= alvo) hi = m;
+        else lo = m + 1;
+    }
+    return lo;
 }
 
-void* thread_artilheiro(void* arg) {
-    GameState* game = (GameState*)arg;
+/* Narrows [*lo, *hi) to where |cell a - cell b| <= HIT_BOX, if the gap is
+   monotone (a and b never move the same way); false once it is empty */
+static bool janela_eixo(Eixo a, Eixo b, int64_t* lo, int64_t* hi) {
+    int s = (a.v > b.v) - (a.v < b.v);
+    if (s == 0) return abs(eixo_celula(a, *lo) - eixo_celula(b, *lo)) <= HIT_BOX;
+    int64_t ini = primeiro_ms(a, b, s, -HIT_BOX, *lo, *hi);
+    int64_t fim = primeiro_ms(a, b, s, HIT_BOX + 1, ini, *hi);
+    *lo = ini;
+    *hi = fim;
+    return ini < fim;
+}
 
-    while (!atomic_load(&game->game_over)) {
-        bool todos_cheios = true;
+static int cmp_impacto(const void* pa, const void* pb) {
+    const Impacto* a = (const Impacto*)pa;
+    const Impacto* b = (const Impacto*)pb;
+    if (a->t != b->t) return (a->t > b->t) - (a->t < b->t);
+    if (a->foguete != b->foguete && (a->foguete < 0 || b->foguete < 0))
+        return (a->foguete < 0) ? -1 : 1;         /* landings first, as ships step first */
+    if (a->nave != b->nave) return a->nave - b->nave;
+    return a->foguete - b->foguete;
+}
 
-        pthread_mutex_lock(&game->mutex_lancadores);
-        for (int i = 0; i < game->num_lancadores; i++) {
-            if (!game->lancadores[i].tem_foguete) {
-                todos_cheios = false;
+int sim_varrer_reservar(GameState* game, int n) {
+    if (n <= game->varre_cap) return 0;
+    Impacto* v = (Impacto*)realloc(game->varre_imp, sizeof(Impacto) * (size_t)n);
+    if (!v) return -1;
+    game->varre_imp = v;
+    game->varre_cap = n;
+    return 0;
+}
 
-                pthread_mutex_lock(&game->mutex_estado);
-                DirecaoDisparo dir_atual = game->direcao_atual;
-                pthread_mutex_unlock(&game->mutex_estado);
+/* Past varre_cap entries are only counted: sim_tick grows the list to the
+   count once the locks are released */
+static inline void impacto_add(GameState* game, int* n, Impacto imp) {
+    if (*n < game->varre_cap) game->varre_imp[*n] = imp;
+    if (*n < INT_MAX / 2) (*n)++;
+}
 
-                pthread_mutex_unlock(&game->mutex_lancadores);
-                usleep(game->tempo_recarga * 1000);
-                pthread_mutex_lock(&game->mutex_lancadores);
+/* Cell of dense entry p at time t, as col_avancar would leave it */
+static inline void celula_em(const EntityCols* c, int p, int64_t t, int* x, int* y) {
+    int64_t dt = t - c->t0_ms[p];
+    *x = (dt <= 0) ? c->x[p] : fx_celula(c->ox[p], c->vx[p], dt);
+    *y = (dt <= 0) ? c->y[p] : fx_celula(c->oy[p], c->vy[p], dt);
+}
 
-                if (!atomic_load(&game->game_over) && !game->lancadores[i].tem_foguete) {
-                    game->lancadores[i].tem_foguete = true;
-                    game->lancadores[i].direcao = dir_atual;
-                }
-                break;
-            }
+/* Caller holds mutex_naves -> mutex_foguetes. Collects every hit and
+   landing before it moves anything, so when they outnumber varre_cap it
+   returns -1 with the world untouched (*falta = entries needed) and the
+   tick can be stepped instead. */
+static int sim_varrer(GameState* game, int64_t now, int sw, int sh, int hud, int ch, int* falta) {
+    EntityCols* cn = &game->col_naves;
+    EntityCols* cf = &game->col_foguetes;
+    const int ground_y = sh - ch - 1;
+    const int64_t ta = game->sim_t_ms + 1, tb = now + 1;   /* window [ta, tb) */
+    int n = 0, passos = 0;
+
+    /* The landing time is searched only for ships that land by `now`, and
+       the fastest bounds how far any fell */
+    int32_t vmax = 0;
+    for (int p = 0; p < cn->num; p++) {
+        int x, y;
+        celula_em(cn, p, now, &x, &y);
+        int64_t fim = tb;
+        if (y >= ground_y) {
+            int64_t lo = (cn->t0_ms[p] > ta) ? cn->t0_ms[p] : ta;
+            fim = primeiro_ms(eixo_y(cn, p), EIXO_ZERO, 1, ground_y, lo, tb);
+            impacto_add(game, &n, (Impacto){ fim, cn->id[p], -1 });
         }
-
-        if (todos_cheios) {
-            while (!atomic_load(&game->game_over)) {
-                pthread_cond_wait(&game->cond_lancador_vazio, &game->mutex_lancadores);
-                bool any_empty = false;
-                for (int i = 0; i < game->num_lancadores; i++)
-                    if (!game->lancadores[i].tem_foguete) { any_empty = true; break; }
-                if (any_empty) break;
-            }
+        game->varre_fim[cn->id[p]] = fim;
+        if (cn->vy[p] > vmax) vmax = cn->vy[p];
+    }
+    const int queda = fx_celula(0, vmax, tb - ta) + 1;
+
+    /* Rockets: every ship near the path from the old cell to the new one,
+       and the first millisecond the two overlap */
+    for (int p = 0; p < cf->num; p++) {
+        const Eixo rx = eixo_x(cf, p), ry = eixo_y(cf, p);
+        const int xa = cf->x[p], ya = cf->y[p];
+        int xb, yb;
+        celula_em(cf, p, now, &xb, &yb);
+        int64_t lo = (cf->t0_ms[p] > ta) ? cf->t0_ms[p] : ta, hi = tb;
+        if (xb < 0)   hi = primeiro_ms(rx, EIXO_ZERO, -1, 1, lo, hi);      /* leaves the screen */
+        if (xb >= sw) hi = primeiro_ms(rx, EIXO_ZERO, 1, sw, lo, hi);
+        if (yb < hud) hi = primeiro_ms(ry, EIXO_ZERO, -1, 1 - hud, lo, hi);
+        if (lo >= hi) continue;
+
+        int x0 = (xa < xb ? xa : xb) - HIT_BOX, x1 = (xa < xb ? xb : xa) + HIT_BOX;
+        int y0 = (ya < yb ? ya : yb) - HIT_BOX - queda, y1 = (ya < yb ? yb : ya) + HIT_BOX;
+        GRID_FOR_EACH_RECT(&game->grid_naves, x0, y0, x1, y1, i) {
+            int q = cn->pos[i];
+            int64_t a = (cn->t0_ms[q] > lo) ? cn->t0_ms[q] : lo;
+            int64_t b = (game->varre_fim[i] < hi) ? game->varre_fim[i] : hi;
+            if (a < b && janela_eixo(rx, eixo_x(cn, q), &a, &b) && janela_eixo(ry, eixo_y(cn, q), &a, &b))
+                impacto_add(game, &n, (Impacto){ a, i, cf->id[p] });
         }
+    }
+    if (n > game->varre_cap) { *falta = n; return -1; }
+
+    /* Everything moves to `now` (the grid keeps the old cells until the end) */
+    for (int p = 0; p < cn->num; p++) if (col_avancar(cn, p, now)) passos++;
+    for (int p = 0; p < cf->num; p++) if (col_avancar(cf, p, now)) passos++;
+
+    /* In time order; an entity already gone drops its later entries */
+    qsort(game->varre_imp, (size_t)n, sizeof(Impacto), cmp_impacto);
+    for (int k = 0; k < n; k++) {
+        const Impacto* e = &game->varre_imp[k];
+        if (!col_viva(cn, e->nave) || (e->foguete >= 0 && !col_viva(cf, e->foguete))) continue;
+        int q = cn->pos[e->nave];
+        int x = eixo_celula(eixo_x(cn, q), e->t), y = eixo_celula(eixo_y(cn, q), e->t);
+        nave_desativar(game, e->nave);
+        if (e->foguete < 0) {
+            tick_evento(game, EV_CHEGADA, x, y);
+        } else {
+            foguete_desativar(game, e->foguete);
+            game->naves[e->nave].destruida = true;
+            tick_evento(game, EV_ABATE, x, y);
+        }
+    }
+
+    /* Survivors are already at `now`: off-screen rockets go, the grid follows */
+    for (int p = 0; p < cn->num; p++)
+        grid_move(&game->grid_naves, cn->id[p], cn->x[p], cn->y[p]);
+    for (int p = 0; p < cf->num; ) {
+        int id = cf->id[p], x = cf->x[p], y = cf->y[p];
+        if (x < 0 || x >= sw || y < hud || y >= (sh - ch)) { foguete_desativar(game, id); continue; }
+        grid_move(&game->grid_foguetes, id, x, y);
+        p++;
+    }
+    return passos;
+}
 
-        pthread_mutex_unlock(&game->mutex_lancadores);
+int sim_tick(GameState* game, int64_t now) {
+    uint64_t t_prof = prof_inicio();
+    int passos = 0;
+    Metricas m = game_metricas(game);
+    int sw = m.w, sh = m.h, hud = m.hud, ch = m.ch;
+
+    const int ground_y = sh - ch - 1;
+    EntityCols* cn = &game->col_naves;
+    EntityCols* cf = &game->col_foguetes;
+
+    LOCK(game, naves);
+    LOCK(game, foguetes);
+
+    /* A swept tick that finds more hits than the list holds is stepped
+       below instead, and the list grows once the locks are released */
+    int falta = 0;
+    if (game->varrido && now > game->sim_t_ms) {
+        passos = sim_varrer(game, now, sw, sh, hud, ch, &falta);
+        if (passos >= 0) game->sim_t_ms = now;
+        else passos = 0;
     }
+
+    /* Sub-steps: at most one cell per entity each, so ships and rockets
+       interleave the way their pooled steps would. Dense walks: a
+       swap-remove refills index p, so p only advances when the entity
+       there survived or did not change cell. */
+    int64_t t = game->sim_t_ms;
+    while (t < now) {
+        t += game->passo_min_ms;
+        if (t > now) t = now;
+        for (int p = 0; p < cn->num; ) {
+            if (!col_avancar(cn, p, t)) { p++; continue; }
+            passos++;
+            if (tick_passo_nave(game, p, ground_y)) p++;
+        }
+        for (int p = 0; p < cf->num; ) {
+            if (!col_avancar(cf, p, t)) { p++; continue; }
+            passos++;
+            if (tick_passo_foguete(game, p, sw, sh, hud, ch)) p++;
+        }
+    }
+    if (now > game->sim_t_ms) game->sim_t_ms = now;
+
+    UNLOCK(game, foguetes);
+    UNLOCK(game, naves);
+    if (falta > 0) sim_varrer_reservar(game, 2 * falta);   /* on failure, the next big tick steps too */
+    tick_publicar(game);
+
+    prof_fim(PROF_FASE_TICK, t_prof);
+    return passos;
+}
+
+void recarga_tick(GameState* game, int64_t now) {
+    int64_t proxima;
+    LOCK(game, lancadores);
+    recarga_vencidas(game, now, &proxima);
+    UNLOCK(game, lancadores);
+}
+
+void* thread_simulacao(void* arg) {
+    PROF_THREAD_ENTER();
+    GameState* game = (GameState*)arg;
+    int64_t prazo = mono_ns();
+
+    do {
+        game_apply_resize(game);
+        if (!atomic_load(&game->game_over)) sim_tick(game, game_now_ms(game));   /* not between rounds */
+        snapshot_publish(game->snap_render, game);
+        prazo += (int64_t)game->tick_ms * 1000000LL;
+    } while (game_esperar_ns(game, prazo));
+    PROF_THREAD_EXIT();
     return NULL;
 }
@@ -9,13 +9,24 @@
 
 void* thread_principal(void* arg);
 void* thread_input(void* arg);
-void* thread_nave(void* arg);
-void* thread_foguete(void* arg);
 void* thread_artilheiro(void* arg);
+void* thread_simulacao(void* arg);
 
-typedef struct {
-    void* entity;     /* Nave* or Foguete* */
-    GameState* game;
-} ThreadArgs;
+/* SIM_THREADS pool tasks (PoolFn, see pool.h): one step of ship/rocket
+   slot `id`; return the next step time, or -1 once the slot is released */
+int64_t nave_passo(void* ctx, int id);
+int64_t foguete_passo(void* ctx, int id);
+
+/* SIM_TICK: advance every due ship/rocket to time `now` (ms) in one pass;
+   returns the number of entity steps taken */
+int  sim_tick(GameState* game, int64_t now);
+
+/* --swept: sizes the hit list for n entries (0, or -1 out of memory). A
+   tick that finds more steps instead and grows it after its locks. */
+int  sim_varrer_reservar(GameState* game, int n);
+
+/* SIM_TICK without a loader thread: loads every launcher whose reload
+   deadline has passed on the game clock (same schedule as thread_artilheiro) */
+void recarga_tick(GameState* game, int64_t now);
 
 #endif /* THREADS_H */
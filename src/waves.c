@@ -0,0 +1,98 @@
+/**
+ * waves.c - Spawn timeline generator (see waves.h)
+ */
+#include "waves.h"
+#include <stdlib.h>
+#include <string.h>
+
+int ondas_init(Ondas* o) {
+    memset(o, 0, sizeof(*o));
+    o->bloco = (OndaNave*)malloc(sizeof(OndaNave) * ONDA_BLOCO);
+    return o->bloco ? 0 : -1;
+}
+
+void ondas_free(Ondas* o) {
+    free(o->bloco);
+    memset(o, 0, sizeof(*o));
+}
+
+static inline uint16_t sorteio16(GameState* game) { return (uint16_t)(game_rand(game) >> 16); }
+
+/* Lays out the next wave: its kind, size and the gap to the one after */
+static void nova_onda(Ondas* o, GameState* game) {
+    const DifficultyConfig* c = &game->cfg;
+    o->ondas++;
+    if (c->enxame > 0 && o->ondas % ONDA_ENXAME_CADA == 0) {
+        o->tipo = ONDA_ENXAME;
+        o->n = c->enxame;
+    } else if (c->formacao_max > 1) {
+        o->tipo = (OndaTipo)(game_rand(game) % ONDA_ENXAME);   /* AVULSA..RAJADA */
+        o->n = (o->tipo == ONDA_AVULSA) ? 1 : 2 + (int)(game_rand(game) % (uint32_t)(c->formacao_max - 1));
+    } else {
+        o->tipo = ONDA_AVULSA;
+        o->n = 1;
+    }
+    if (o->n > o->restantes) o->n = o->restantes;
+    o->restantes -= o->n;
+    o->i = 0;
+    o->t0 = o->t_prox;
+    o->ancora = sorteio16(game);
+
+    /* n intervals keep the average rate; a chevron or burst that lasts
+       longer pushes the next wave back rather than overlap it */
+    int64_t gap = 0, dura = 0;
+    for (int k = 0; k < o->n; k++) gap += game_next_spawn_ms(game);
+    if (o->tipo == ONDA_V) dura = (int64_t)(o->n / 2) * c->ship_speed_ms;
+    if (o->tipo == ONDA_RAJADA) dura = (int64_t)(o->n - 1) * ONDA_RAJADA_MS;
+    o->t_prox = o->t0 + ((gap > dura) ? gap : dura + c->spawn_min_ms);
+}
+
+/* The wave's next ship. Emission order is time order: a chevron emits its
+   leader first, then each row's pair. */
+static OndaNave emitir(Ondas* o, GameState* game) {
+    const int i = o->i++, n = o->n;
+    OndaNave e = { o->t0, o->ancora, 0, 1 };
+    switch (o->tipo) {
+        case ONDA_AVULSA:
+            break;
+        case ONDA_LINHA:
+            e.largura = (uint16_t)((n - 1) * ONDA_ESPACO + 1);
+            e.off = (uint16_t)(i * ONDA_ESPACO);
+            break;
+        case ONDA_V: {
+            const int fila = (i + 1) / 2;            /* odd: left wing, even: right */
+            const int ponta = (n / 2) * ONDA_ESPACO; /* leader's offset (left wing has n/2 ships) */
+            e.largura = (uint16_t)((n - 1) * ONDA_ESPACO + 1);
+            e.off = (uint16_t)(ponta + ((i & 1) ? -fila : fila) * ONDA_ESPACO);
+            e.t_ms += (int64_t)fila * game->cfg.ship_speed_ms;
+            break;
+        }
+        case ONDA_RAJADA:
+            e.t_ms += (int64_t)i * ONDA_RAJADA_MS;
+            if (i > 0) e.ancora = sorteio16(game);
+            break;
+        case ONDA_ENXAME:   /* one ship per 1/n of the width, jittered inside it */
+            e.ancora = (uint16_t)(((uint64_t)i * 65536u + sorteio16(game)) / (uint64_t)n);
+            break;
+        case ONDA_NUM:
+            break;
+    }
+    return e;
+}
+
+bool ondas_encher(Ondas* o, GameState* game) {
+    o->num = o->cur = 0;
+    while (o->num < ONDA_BLOCO && (o->i < o->n || o->restantes > 0)) {
+        if (o->i == o->n) nova_onda(o, game);
+        o->bloco[o->num++] = emitir(o, game);
+    }
+    return o->num > 0;
+}
+
+void ondas_iniciar(Ondas* o, GameState* game) {
+    o->restantes = game->naves_total;
+    o->n = o->i = 0;
+    o->ondas = 0;
+    o->t_prox = game_next_spawn_ms(game);   /* the first ship waits one interval */
+    ondas_encher(o, game);
+}
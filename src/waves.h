@@ -0,0 +1,83 @@
+#ifndef WAVES_H
+#define WAVES_H
+
+/**
+ * waves.h - Level spawn timeline: single ships, formations, bursts, swarms
+ *
+ * At level start (game_init, game_reset) the spawner's PRNG lays out when
+ * and where every ship of the level enters, grouped into waves:
+ *
+ *     ONDA_AVULSA   one ship
+ *     ONDA_LINHA    a row of ships ONDA_ESPACO cells apart
+ *     ONDA_V        a chevron: the leader, then a pair one ship step behind
+ *                   it for every further row
+ *     ONDA_RAJADA   a burst of ships ONDA_RAJADA_MS apart at random columns
+ *     ONDA_ENXAME   DifficultyConfig.enxame ships at once across the width,
+ *                   every ONDA_ENXAME_CADA-th wave
+ *
+ * Formations and bursts hold 2..formacao_max ships, so formacao_max <= 1
+ * with enxame == 0 is the one-ship-per-interval spawner. A wave of n ships
+ * is followed by n spawn intervals, which keeps the profile's average
+ * rate, and never by less than the wave itself lasts, so the timeline is
+ * sorted by construction.
+ *
+ * Entries are generated ONDA_BLOCO at a time, the next block when the
+ * spawner has admitted the last one, so a ten-million-ship profile needs
+ * no more memory than a 60-ship one. A column is a fraction of the free
+ * width plus an offset inside the wave, resolved when the ship enters:
+ * a formation never straddles an edge, and keeps its shape on any field
+ * at least as wide as it is. A wider one is squeezed to the field width
+ * (ondas_coluna), closer together but still in order. Spawner only (thread_principal or the headless loop), no lock.
+ */
+
+#include "game.h"
+
+#define ONDA_BLOCO       1024    /* timeline entries generated at a time */
+#define ONDA_ESPACO      4       /* cells between ships of a row or chevron */
+#define ONDA_RAJADA_MS   150     /* gap between the ships of a burst */
+#define ONDA_ENXAME_CADA 8       /* every 8th wave is a swarm (when enxame > 0) */
+#define ONDA_FORMACAO_MAX 64     /* formacao_max limit: 253 cells wide, squeezed on narrower fields */
+
+typedef enum { ONDA_AVULSA, ONDA_LINHA, ONDA_V, ONDA_RAJADA, ONDA_ENXAME, ONDA_NUM } OndaTipo;
+
+typedef struct {
+    int64_t t_ms;         /* entry time, game ms since start_ms */
+    uint16_t ancora;      /* wave position, fraction of (w - largura + 1) */
+    uint16_t off;         /* this ship's cell offset from the wave's left edge */
+    uint16_t largura;     /* wave width in cells */
+} OndaNave;
+
+typedef struct Ondas {
+    OndaNave* bloco;      /* [ONDA_BLOCO] upcoming entries, sorted by t_ms */
+    int num, cur;         /* entries in bloco, next one to admit */
+
+    /* Generator: the wave being laid out and where the next one starts */
+    int restantes;        /* ships of the level not in a wave yet */
+    OndaTipo tipo;
+    int n, i;             /* its size, next ship */
+    int64_t t0, t_prox;
+    uint16_t ancora;
+    int ondas;            /* waves started this level */
+} Ondas;
+
+int  ondas_init(Ondas* o);    /* 0 on success */
+void ondas_free(Ondas* o);
+
+/* New level: lays out the first block from game->rng and the profile */
+void ondas_iniciar(Ondas* o, GameState* game);
+
+/* Next block once the current one is used up; false when the level has
+   no ships left to lay out */
+bool ondas_encher(Ondas* o, GameState* game);
+
+/* Column of an entry on a field w cells wide. A wave wider than the field
+   is squeezed onto it: offsets scale by (w - 1) / (largura - 1), so its
+   ships stay apart and in order instead of piling up on the right edge. */
+static inline int ondas_coluna(const OndaNave* e, int w) {
+    if (w <= 0) return 0;
+    const int folga = w - (int)e->largura;
+    if (folga < 0) return (int)((uint32_t)e->off * (uint32_t)(w - 1) / (uint32_t)(e->largura - 1));
+    return (int)(((uint32_t)e->ancora * (uint32_t)(folga + 1)) >> 16) + e->off;
+}
+
+#endif /* WAVES_H */